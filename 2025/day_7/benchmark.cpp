@@ -0,0 +1,244 @@
+// Benchmarks for the day 7 solvers on generated tachyon manifolds
+// compile: g++ -std=c++17 -O2 -pthread -o benchmark benchmark.cpp
+// run:     ./benchmark [--sizes=RxC,RxC,...] [--reps=N] [--warmup=N] [--seed=N] [--density=F] [--clustering=F]
+// grid:    ./benchmark --generate=RxC [--seed=N] [--density=F] [--clustering=F] > grid.txt
+#define BENCHMARK_MODE
+#define RESULT_IMPLEMENTATION
+#include "result.cpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+// Heap accounting for the peak memory column, every allocation carries its size in front
+static std::atomic<size_t> heapCurrent{0};
+static std::atomic<size_t> heapPeak{0};
+static const size_t HEADER = 16;
+
+void *operator new(size_t size)
+{
+  char *block = (char *)malloc(size + HEADER);
+  if (!block)
+    throw std::bad_alloc();
+  *(size_t *)block = size;
+  size_t now = heapCurrent += size;
+  size_t peak = heapPeak.load();
+  while (now > peak && !heapPeak.compare_exchange_weak(peak, now))
+  {
+  }
+  return block + HEADER;
+}
+
+// not inlined, or GCC pairs the free with the new-expression and warns
+__attribute__((noinline)) void operator delete(void *p) noexcept
+{
+  if (!p)
+    return;
+  char *block = (char *)p - HEADER;
+  heapCurrent -= *(size_t *)block;
+  free(block);
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete[](void *p) noexcept { operator delete(p); }
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+void operator delete[](void *p, size_t) noexcept { operator delete(p); }
+
+// Generator parameters
+// density: share of splitter-row cells that are '^'
+// clustering: 0 scatters splitters independently, towards 1 they come in runs
+struct ManifoldParams
+{
+  int rows = 1024;
+  int cols = 1024;
+  double density = 0.3;
+  double clustering = 0.0;
+  unsigned long long seed = 7;
+};
+
+// Same shape as the puzzle input: 'S' in the middle of the top row, splitters on
+// every other row. Each splitter row is a two-state Markov chain whose stationary
+// share of '^' is density, clustering raises the chance that a '^' follows a '^'.
+Grid generateManifold(const ManifoldParams &params)
+{
+  Grid grid;
+  grid.rows = params.rows;
+  grid.cols = params.cols;
+  grid.stride = params.cols + 1;
+
+  size_t size = 1 + (size_t)grid.rows * grid.stride;
+  char *buffer = new char[size];
+  grid.storage.reset(buffer, std::default_delete<char[]>());
+  grid.cells = buffer + 1;
+  buffer[0] = GRID_PAD;
+
+  std::mt19937_64 rng(params.seed);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  double afterSplitter = params.density + params.clustering * (1.0 - params.density);
+  double afterEmpty = params.density * (1.0 - params.clustering);
+
+  for (int r = 0; r < grid.rows; r++)
+  {
+    char *row = buffer + 1 + (size_t)r * grid.stride;
+    memset(row, '.', grid.cols);
+    row[grid.cols] = GRID_PAD;
+    if (r % 2 == 0 && r > 0)
+    {
+      bool previous = false;
+      for (int c = 0; c < grid.cols; c++)
+      {
+        previous = uniform(rng) < (previous ? afterSplitter : afterEmpty);
+        if (previous)
+          row[c] = '^';
+      }
+    }
+  }
+  if (grid.rows > 0 && grid.cols > 0)
+    buffer[1 + grid.cols / 2] = 'S';
+
+  return grid;
+}
+
+struct Variant
+{
+  const char *name;
+  int maxRows; // deeper grids are skipped, the recursive DFS would run out of stack
+  std::function<unsigned long long(const Grid &grid)> run;
+};
+
+std::vector<Variant> variants()
+{
+  return {
+      {"part1 bfs", 0, [](const Grid &grid)
+       { return (unsigned long long)solpart1Observed(grid, NullObserver()); }},
+      {"part1 bfs std::function", 0, [](const Grid &grid)
+       { return (unsigned long long)solpart1(grid, [](int, int, int, int, const SplitterView &) {}); }},
+      {"part1 bitset", 0, [](const Grid &grid)
+       { return (unsigned long long)solpart1Bitset(grid); }},
+      {"part2 dfs", 20000, [](const Grid &grid)
+       { return (unsigned long long)solpart2Observed(grid, NullObserver()); }},
+      {"part2 sweep u64", 0, [](const Grid &grid)
+       { return countTimelines<unsigned long long>(grid); }},
+      {"part2 sweep u128", 0, [](const Grid &grid)
+       { return (unsigned long long)countTimelines<unsigned __int128>(grid); }},
+      {"part2 sweep big256", 0, [](const Grid &grid)
+       { return countTimelines<BigCounter<4>>(grid).limb[0]; }},
+      {"part2 sweep mod", 0, [](const Grid &grid)
+       { return countTimelines<ModCounter<1000000007>>(grid).value; }},
+      {"both streaming", 0, [](const Grid &grid)
+       {
+         StreamingSolver<> solver;
+         for (int r = 0; r < grid.rows; r++)
+           solver.pushRow(grid.line(r));
+         return solver.timelines() + solver.splits();
+       }},
+  };
+}
+
+bool parseSize(const std::string &text, int &rows, int &cols)
+{
+  return sscanf(text.c_str(), "%dx%d", &rows, &cols) == 2 && rows > 0 && cols > 0;
+}
+
+int main(int argc, char *argv[])
+{
+  ManifoldParams params;
+  std::vector<std::pair<int, int>> sizes = {{256, 256}, {1024, 1024}, {4096, 4096}, {100000, 256}};
+  int reps = 5;
+  int warmup = 1;
+  bool generate = false;
+
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    std::string value = arg.substr(arg.find('=') + 1);
+    if (arg.rfind("--sizes=", 0) == 0)
+    {
+      sizes.clear();
+      size_t start = 0;
+      while (start <= value.size())
+      {
+        size_t end = value.find(',', start);
+        if (end == std::string::npos)
+          end = value.size();
+        int rows, cols;
+        if (!parseSize(value.substr(start, end - start), rows, cols))
+        {
+          std::cerr << "Bad size in " << arg << std::endl;
+          return 1;
+        }
+        sizes.push_back({rows, cols});
+        start = end + 1;
+      }
+    }
+    else if (arg.rfind("--generate=", 0) == 0 && parseSize(value, params.rows, params.cols))
+      generate = true;
+    else if (arg.rfind("--reps=", 0) == 0)
+      reps = std::max(1, std::atoi(value.c_str()));
+    else if (arg.rfind("--warmup=", 0) == 0)
+      warmup = std::max(0, std::atoi(value.c_str()));
+    else if (arg.rfind("--seed=", 0) == 0)
+      params.seed = std::strtoull(value.c_str(), nullptr, 10);
+    else if (arg.rfind("--density=", 0) == 0)
+      params.density = std::atof(value.c_str());
+    else if (arg.rfind("--clustering=", 0) == 0)
+      params.clustering = std::atof(value.c_str());
+    else
+    {
+      std::cerr << "Unknown argument: " << arg << std::endl;
+      return 1;
+    }
+  }
+
+  if (generate)
+  {
+    Grid grid = generateManifold(params);
+    for (int r = 0; r < grid.rows; r++)
+      fwrite(grid.row(r), 1, grid.cols + 1, stdout);
+    return 0;
+  }
+
+  printf("%-24s %8s %6s %10s %10s %12s %12s\n", "variant", "rows", "cols", "best ms", "median ms", "Mcells/s", "peak heap KB");
+  for (auto [rows, cols] : sizes)
+  {
+    params.rows = rows;
+    params.cols = cols;
+    Grid grid = generateManifold(params);
+    double cells = (double)rows * cols;
+
+    for (const Variant &variant : variants())
+    {
+      if (variant.maxRows > 0 && rows > variant.maxRows)
+      {
+        printf("%-24s %8d %6d %10s\n", variant.name, rows, cols, "skipped");
+        continue;
+      }
+
+      for (int i = 0; i < warmup; i++)
+        variant.run(grid);
+
+      std::vector<double> times;
+      size_t peak = 0;
+      unsigned long long answer = 0;
+      for (int i = 0; i < reps; i++)
+      {
+        size_t base = heapCurrent.load();
+        heapPeak = base;
+        auto start = std::chrono::steady_clock::now();
+        answer = variant.run(grid);
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        peak = std::max(peak, heapPeak.load() - base);
+      }
+      std::sort(times.begin(), times.end());
+      double median = times[times.size() / 2];
+
+      printf("%-24s %8d %6d %10.3f %10.3f %12.1f %12zu\n", variant.name, rows, cols, times.front(), median,
+             cells / median / 1000.0, peak / 1024);
+      (void)answer;
+    }
+  }
+
+  return 0;
+}
@@ -1,17 +1,66 @@
 // https://adventofcode.com/2025/day/7
+// compile: g++ -std=c++17 -O2 -pthread -DRESULT_IMPLEMENTATION -o result result.cpp
 #ifndef RESULT_H
 #define RESULT_H
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <queue>
-#include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <functional>
 #include <thread>
 #include <chrono>
+#include <type_traits>
+#include <atomic>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SWEEP_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// Padding byte around every row of a Grid, a beam that reads it has left the grid
+const char GRID_PAD = '\n';
+
+// Row-major grid in one contiguous buffer.
+// Each row is followed by a GRID_PAD byte and the buffer starts with one, so with
+// stride = cols + 1 both (r, -1) and (r, cols) are readable pads for every row.
+// This is the same layout as the input file itself, one line per row.
+// Copies share the buffer.
+struct Grid
+{
+  int rows = 0;
+  int cols = 0;
+  int stride = 1;
+  const char *cells = nullptr;         // points at (0, 0)
+  std::shared_ptr<const char> storage; // keeps cells alive
+
+  Grid() = default;
+  // Adapter for callers holding lines, copies them once into the flat buffer.
+  // Rows shorter than the first one are filled with '.'
+  Grid(const std::vector<std::string> &lines);
+
+  char at(int r, int c) const { return cells[(size_t)r * stride + c]; }
+  const char *row(int r) const { return cells + (size_t)r * stride; }
+  std::string_view line(int r) const { return std::string_view(row(r), cols); }
+};
+
+// Map an input file and use it as the Grid buffer directly, the newlines are the padding.
+// All rows must have the same width; CRLF files fall back to one copy.
+// Returns false and fills error if the file can't be read or is ragged.
+bool loadGrid(const std::string &path, Grid &grid, std::string &error);
 
 struct Beam
 {
@@ -26,47 +75,777 @@ enum DFSAction
   DFS_RETURN
 };
 
+// Read-only view of the splitters hit so far, one bit per grid cell
+class SplitterView
+{
+public:
+  bool contains(int r, int c) const
+  {
+    size_t bit = (size_t)r * cols + c;
+    return bits[bit / 64] >> (bit % 64) & 1;
+  }
+  size_t size() const { return count; }
+
+protected:
+  int cols = 0;
+  size_t count = 0;
+  std::vector<unsigned long long> bits;
+};
+
+// Dense set of hit splitters, sized from the grid so inserts never allocate
+class SplitterBitmap : public SplitterView
+{
+public:
+  SplitterBitmap(int rows, int cols)
+  {
+    this->cols = cols;
+    bits.assign(((size_t)rows * cols + 63) / 64, 0);
+  }
+
+  // True if (r, c) was not in the set yet
+  bool insert(int r, int c)
+  {
+    size_t bit = (size_t)r * cols + c;
+    unsigned long long &word = bits[bit / 64];
+    unsigned long long mask = 1ULL << (bit % 64);
+    if (word & mask)
+      return false;
+    word |= mask;
+    count++;
+    return true;
+  }
+};
+
+// Solver statistics, compiled in with -DSOLVER_STATS (main then prints them to stderr as JSON)
+// Without it SOLVER_STAT(...) expands to nothing and the hot loops are unchanged.
+// Counters are per thread and accumulate until resetSolverStats().
+struct SolverStats
+{
+  long long cellsStepped = 0;          // cells walked by BFS/DFS, rows * cols for the row engines
+  long long beamsEnqueued = 0;         // BFS queue pushes
+  long long duplicateSplitterHits = 0; // BFS beams stopped by an already split splitter
+  long long memoHits = 0;
+  long long memoMisses = 0;
+  size_t peakMemoSize = 0;
+  int recursionDepth = 0;
+  int maxRecursionDepth = 0;
+  double locateSeconds = 0; // time spent in findStart
+};
+
+inline SolverStats &solverStats()
+{
+  thread_local SolverStats stats;
+  return stats;
+}
+inline void resetSolverStats() { solverStats() = SolverStats(); }
+
+// Adds the wall-clock time of its scope to seconds
+struct SolverPhaseTimer
+{
+  double &seconds;
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+  SolverPhaseTimer(double &seconds) : seconds(seconds) {}
+  ~SolverPhaseTimer() { seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count(); }
+};
+
+#ifdef SOLVER_STATS
+#define SOLVER_STAT(statement) do { SolverStats &stats = solverStats(); statement; } while (0)
+
+// Tracks the DFS depth for as long as it lives
+struct SolverDepthGuard
+{
+  SolverDepthGuard()
+  {
+    SolverStats &stats = solverStats();
+    stats.maxRecursionDepth = std::max(stats.maxRecursionDepth, ++stats.recursionDepth);
+  }
+  ~SolverDepthGuard() { solverStats().recursionDepth--; }
+};
+#else
+#define SOLVER_STAT(statement) do { } while (0)
+#endif
+
 // Callback types
 // r, c: current position
 // from_r, from_c: previous position (for drawing lines)
-// visitedSplitters: current set of splitters
-using Part1Callback = std::function<void(int r, int c, int from_r, int from_c, const std::set<std::pair<int, int>> &visitedSplitters)>;
+// visitedSplitters: splitters hit so far
+using Part1Callback = std::function<void(int r, int c, int from_r, int from_c, const SplitterView &visitedSplitters)>;
 using Part2Callback = std::function<void(int r, int c, int from_r, int from_c, DFSAction action, long long val)>;
 
-int solpart1(const std::vector<std::string> &grid, Part1Callback callback = nullptr);
-long long solpart2(const std::vector<std::string> &grid, Part2Callback callback = nullptr);
+// Part 1 engines
+// PART1_BFS: queue of beams walked cell by cell, the only engine that reports callbacks
+// PART1_BITSET: active beam columns kept as 64-bit words, advanced a whole row at a time
+enum Part1Engine
+{
+  PART1_BFS,
+  PART1_BITSET
+};
+
+// Part 2 engines
+// PART2_DFS: recursive DFS with memo, the only engine that reports callbacks
+// PART2_ROW_SWEEP: bottom-up sweep over two rolling rows, O(cols) memory and no recursion
+// solpart2 without a callback always takes the sweep
+enum Part2Engine
+{
+  PART2_DFS,
+  PART2_ROW_SWEEP
+};
 
-#endif // RESULT_H
+bool findStart(const Grid &grid, int &startRow, int &startCol);
+// Every 'S' as (row, col), in row-major order
+std::vector<std::pair<int, int>> findSources(const Grid &grid);
+int solpart1(const Grid &grid, Part1Callback callback = nullptr);
+int solpart1(const Grid &grid, Part1Engine engine);
+int solpart1Bitset(const Grid &grid);
+long long solpart2(const Grid &grid, Part2Callback callback = nullptr);
+long long solpart2(const Grid &grid, Part2Engine engine);
+long long solpart2Dfs(const Grid &grid, Part2Callback callback);
+long long solpart2Sweep(const Grid &grid);
+template <typename Observer>
+int solpart1Observed(const Grid &grid, Observer &&observer);
+template <typename Observer>
+long long solpart2Observed(const Grid &grid, Observer &&observer);
 
-#ifdef RESULT_IMPLEMENTATION
-int solpart1(const std::vector<std::string> &grid, Part1Callback callback)
+// Bit i of the result is set if line[i] == '^', for count <= 64 bytes
+using SplitterMaskKernel = unsigned long long (*)(const char *line, int count);
+unsigned long long splitterMaskScalar(const char *line, int count);
+// AVX2 (two 32-byte compares per full word) or scalar, picked once at first use
+SplitterMaskKernel splitterMaskKernel();
+
+// Beam columns of one row as a bitset, bit c of active marks a beam in column c.
+// advance moves the beams through a row: splitters under a beam are hit, their
+// beams stop and reappear one column to either side, carries between words move
+// the bits that cross a 64-column boundary. Returns the number of splitters hit.
+// Only the words from first to last hold beams, advance looks at those and one
+// word to either side, so a narrow front costs the same on any grid width.
+struct BeamFront
 {
-  int rows = grid.size();
-  int cols = rows > 0 ? grid[0].size() : 0;
+  int cols;
+  int words;
+  int first, last; // active words are zero outside [first, last)
+  unsigned long long lastMask;
+  SplitterMaskKernel splitterMask;
+  std::vector<unsigned long long> active, splitters, hits;
+
+  explicit BeamFront(int cols);
+  void add(int c);
+  bool empty() const;
+  int advance(const char *line);
+};
+
+// One bottom-up step of the sweep over the padded rows (column c at index c + 1):
+// current[c + 1] = row[c] == '^' ? below[c] + below[c + 2] : below[c + 1]
+template <typename Counter>
+void sweepRowScalar(const char *row, const Counter *below, Counter *current, int cols)
+{
+  for (int c = 0; c < cols; c++)
+    current[c + 1] = row[c] == '^' ? below[c] + below[c + 2] : below[c + 1];
+}
+
+using SweepRowKernel = void (*)(const char *row, const unsigned long long *below, unsigned long long *current, int cols);
+// Widest kernel the CPU supports (AVX-512F, AVX2 or scalar), picked once at first use
+SweepRowKernel sweepRowKernel();
+
+// The step for any Counter, 64-bit counters go through sweepRowKernel()
+template <typename Counter>
+void sweepRow(const char *row, const Counter *below, Counter *current, int cols)
+{
+  if constexpr (std::is_same<Counter, unsigned long long>::value)
+    sweepRowKernel()(row, below, current, cols);
+  else
+    sweepRowScalar(row, below, current, cols);
+}
+
+// Counter types for countTimelines, picked at compile time
+// unsigned long long: native, wraps mod 2^64
+// unsigned __int128: two native words, exact up to 2^128
+// BigCounter<Limbs>: fixed width unsigned integer of Limbs 64-bit words
+// ModCounter<P>: counts mod P, for when only a residue is needed
+template <int Limbs>
+struct BigCounter
+{
+  unsigned long long limb[Limbs] = {}; // least significant first
+
+  BigCounter() = default;
+  BigCounter(unsigned long long value) { limb[0] = value; }
+
+  bool operator==(const BigCounter &other) const
+  {
+    for (int i = 0; i < Limbs; i++)
+    {
+      if (limb[i] != other.limb[i])
+        return false;
+    }
+    return true;
+  }
+  bool operator!=(const BigCounter &other) const { return !(*this == other); }
+
+  BigCounter operator+(const BigCounter &other) const
+  {
+    BigCounter sum;
+    bool carry = false;
+    for (int i = 0; i < Limbs; i++)
+    {
+      bool overflow = __builtin_add_overflow(limb[i], other.limb[i], &sum.limb[i]);
+      overflow |= __builtin_add_overflow(sum.limb[i], (unsigned long long)carry, &sum.limb[i]);
+      carry = overflow;
+    }
+    return sum;
+  }
+};
+
+template <unsigned long long P>
+struct ModCounter
+{
+  static_assert(P > 0 && P < (1ULL << 63), "sum of two residues must fit in 64 bits");
+  unsigned long long value = 0;
+
+  ModCounter() = default;
+  ModCounter(unsigned long long v) : value(v % P) {}
+
+  bool operator==(const ModCounter &other) const { return value == other.value; }
+  bool operator!=(const ModCounter &other) const { return value != other.value; }
+
+  ModCounter operator+(const ModCounter &other) const
+  {
+    ModCounter sum;
+    sum.value = value + other.value;
+    if (sum.value >= P)
+      sum.value -= P;
+    return sum;
+  }
+};
+
+inline std::string toString(unsigned long long value)
+{
+  return std::to_string(value);
+}
+
+inline std::string toString(unsigned __int128 value)
+{
+  std::string digits;
+  do
+  {
+    digits += char('0' + (int)(value % 10));
+    value /= 10;
+  } while (value != 0);
+  return std::string(digits.rbegin(), digits.rend());
+}
+
+template <int Limbs>
+std::string toString(const BigCounter<Limbs> &counter)
+{
+  // peel off 19 decimal digits at a time by long division
+  BigCounter<Limbs> value = counter;
+  const unsigned long long chunk = 10000000000000000000ULL;
+  std::vector<unsigned long long> parts;
+  bool zero;
+  do
+  {
+    unsigned __int128 remainder = 0;
+    zero = true;
+    for (int i = Limbs - 1; i >= 0; i--)
+    {
+      unsigned __int128 current = remainder << 64 | value.limb[i];
+      value.limb[i] = (unsigned long long)(current / chunk);
+      remainder = current % chunk;
+      zero &= value.limb[i] == 0;
+    }
+    parts.push_back((unsigned long long)remainder);
+  } while (!zero);
+
+  std::string result = std::to_string(parts.back());
+  for (int i = (int)parts.size() - 2; i >= 0; i--)
+  {
+    std::string part = std::to_string(parts[i]);
+    result += std::string(19 - part.size(), '0') + part;
+  }
+  return result;
+}
+
+template <unsigned long long P>
+std::string toString(const ModCounter<P> &counter)
+{
+  return std::to_string(counter.value);
+}
+
+// Part 2: Row sweep
+// ways[c] holds the number of timelines from (r + 1, c) to the bottom, so walking
+// the rows upwards only ever needs the row below. Both rows carry a zero column on
+// each side, which makes beams leaving the grid drop out without bounds checks.
+// Counter only needs a zero default, construction from 1 and operator+. Cells S
+// never reaches may hold larger counts than the answer, so wrapping counters are
+// still exact whenever the answer itself fits.
+template <typename Counter>
+Counter countTimelines(const Grid &grid)
+{
+  int rows = grid.rows;
+  int cols = grid.cols;
 
-  // Find start position 'S'
   int startRow = -1, startCol = -1;
-  for (int r = 0; r < rows; r++)
+  if (!findStart(grid, startRow, startCol))
+    return Counter();
+
+  std::vector<Counter> below(cols + 2, Counter(1)), current(cols + 2);
+  below[0] = below[cols + 1] = Counter(); // leaving the grid sideways is not a timeline
+  SOLVER_STAT(stats.cellsStepped += (long long)(rows - startRow) * cols);
+
+  for (int r = rows - 1; r >= startRow; r--)
+  {
+    sweepRow(grid.row(r), below.data(), current.data(), cols);
+    std::swap(below, current);
+  }
+
+  return below[startCol + 1];
+}
+
+// Both parts fed one row at a time, top-down, e.g. straight from a pipe.
+// Only the frontier is kept: the beam bitset for Part 1 and the number of
+// timelines in each column for Part 2, so memory is O(cols) however tall the
+// grid is. Rows before the first 'S' are skipped, later 'S' are empty space.
+template <typename Counter = unsigned long long>
+class StreamingSolver
+{
+public:
+  // False if the row is not as wide as the first one
+  bool pushRow(std::string_view row)
+  {
+    if (rowCount == 0)
+      init(row.size());
+    else if ((int)row.size() != cols)
+      return false;
+    rowCount++;
+
+    if (!started)
+    {
+      size_t start = row.find('S');
+      if (start == std::string_view::npos)
+        return true;
+      started = true;
+      front.add(start);
+      ways[start + 1] = Counter(1);
+    }
+
+    // padded copy of the row so the neighbour reads need no bounds checks
+    std::copy(row.begin(), row.end(), line.begin() + 1);
+    const char *cells = line.data() + 1;
+
+    splitCount += front.advance(cells);
+    for (int c = 0; c < cols; c++)
+    {
+      // timelines reaching (r + 1, c): straight through, or split off a neighbour
+      Counter arriving = cells[c] == '^' ? Counter() : ways[c + 1];
+      if (cells[c - 1] == '^')
+        arriving = arriving + ways[c];
+      if (cells[c + 1] == '^')
+        arriving = arriving + ways[c + 2];
+      next[c + 1] = arriving;
+    }
+    std::swap(ways, next);
+    return true;
+  }
+
+  long long splits() const { return splitCount; }
+  int rowsSeen() const { return rowCount; }
+
+  // Timelines leaving the bottom if the grid ended here
+  Counter timelines() const
+  {
+    Counter total = Counter();
+    for (int c = 0; c < cols; c++)
+      total = total + ways[c + 1];
+    return total;
+  }
+
+private:
+  int cols = 0;
+  int rowCount = 0;
+  bool started = false;
+  long long splitCount = 0;
+  BeamFront front{0};
+  std::vector<Counter> ways, next; // padded, column c at index c + 1
+  std::string line;
+
+  void init(size_t width)
   {
+    cols = width;
+    front = BeamFront(cols);
+    ways.assign(cols + 2, Counter());
+    next.assign(cols + 2, Counter());
+    line.assign(cols + 2, '.');
+  }
+};
+
+// Both answers kept up to date while splitters are toggled.
+// Holds its own copy of the grid plus two per-cell tables from the S row down:
+// reach marks the cells a beam passes through (Part 1 counts the reached '^')
+// and ways the timelines from each cell to the bottom (Part 2 reads it at S).
+// A toggle at (r, c) can only change reach below row r and ways above it, each
+// inside a cone that widens by one column per row. Both are walked row by row
+// over the span of columns that actually changed and stop as soon as a row comes
+// out unchanged, so the cost follows the affected region, not the grid.
+// On top of what countTimelines needs, Counter must compare with == and !=.
+template <typename Counter = unsigned long long>
+class IncrementalSolver
+{
+public:
+  explicit IncrementalSolver(const Grid &grid) : rows(grid.rows), cols(grid.cols), width(grid.cols + 2)
+  {
+    cells.assign((size_t)rows * width, '.');
+    for (int r = 0; r < rows; r++)
+      std::copy(grid.row(r), grid.row(r) + cols, cells.begin() + (size_t)r * width + 1);
+
+    if (!findStart(grid, startRow, startCol))
+      return;
+
+    reach.assign((size_t)rows * width, 0);
+    for (int r = startRow; r < rows; r++)
+    {
+      for (int c = 0; c < cols; c++)
+      {
+        reach[index(r, c)] = computeReach(r, c);
+        if (reach[index(r, c)] && cell(r, c) == '^')
+          splitCount++;
+      }
+    }
+
+    ways.assign((size_t)(rows + 1) * width, Counter());
     for (int c = 0; c < cols; c++)
+      ways[index(rows, c)] = Counter(1);
+    for (int r = rows - 1; r >= startRow; r--)
+    {
+      for (int c = 0; c < cols; c++)
+        ways[index(r, c)] = computeWays(r, c);
+    }
+  }
+
+  int splits() const { return splitCount; }
+  Counter timelines() const { return startRow < 0 ? Counter() : ways[index(startRow, startCol)]; }
+
+  // Flip (r, c) between '.' and '^'. Returns false for 'S' and cells outside the grid
+  bool toggleSplitter(int r, int c)
+  {
+    if (r < 0 || r >= rows || c < 0 || c >= cols || cell(r, c) == 'S')
+      return false;
+
+    char &target = cells[index(r, c)];
+    target = target == '^' ? '.' : '^';
+    if (startRow < 0 || r < startRow)
+      return true; // nothing above S is ever reached
+
+    if (reach[index(r, c)])
+      splitCount += target == '^' ? 1 : -1;
+    updateReach(r + 1, c, c);
+    updateWays(r, c, c);
+    return true;
+  }
+
+private:
+  int rows, cols, width;
+  int startRow = -1, startCol = -1;
+  int splitCount = 0;
+  std::vector<char> cells;         // padded with '.', column c at index c + 1
+  std::vector<unsigned char> reach; // same layout
+  std::vector<Counter> ways;        // same layout plus the row below the grid
+
+  size_t index(int r, int c) const { return (size_t)r * width + c + 1; }
+  char cell(int r, int c) const { return cells[index(r, c)]; }
+  bool split(int r, int c) const { return cell(r, c) == '^'; }
+
+  bool computeReach(int r, int c) const
+  {
+    if (r == startRow)
+      return c == startCol;
+    // straight through a non-splitter above, or split off a neighbour above
+    return (reach[index(r - 1, c)] && !split(r - 1, c)) ||
+           (reach[index(r - 1, c - 1)] && split(r - 1, c - 1)) ||
+           (reach[index(r - 1, c + 1)] && split(r - 1, c + 1));
+  }
+
+  Counter computeWays(int r, int c) const
+  {
+    if (split(r, c))
+      return ways[index(r + 1, c - 1)] + ways[index(r + 1, c + 1)];
+    return ways[index(r + 1, c)];
+  }
+
+  // Row r depends on columns lo..hi of row r - 1 having changed
+  void updateReach(int r, int lo, int hi)
+  {
+    for (; r < rows; r++)
     {
-      if (grid[r][c] == 'S')
+      int first = cols, last = -1;
+      for (int c = std::max(0, lo - 1); c <= std::min(cols - 1, hi + 1); c++)
       {
-        startRow = r;
-        startCol = c;
-        break;
+        unsigned char now = computeReach(r, c);
+        if (now == reach[index(r, c)])
+          continue;
+        reach[index(r, c)] = now;
+        if (split(r, c))
+          splitCount += now ? 1 : -1;
+        first = std::min(first, c);
+        last = c;
       }
+      if (last < 0)
+        return;
+      lo = first;
+      hi = last;
     }
-    if (startRow != -1)
-      break;
   }
 
+  // Columns lo..hi of row r need recomputing, rows above follow what changed
+  void updateWays(int r, int lo, int hi)
+  {
+    for (; r >= startRow; r--)
+    {
+      int first = cols, last = -1;
+      for (int c = std::max(0, lo); c <= std::min(cols - 1, hi); c++)
+      {
+        Counter now = computeWays(r, c);
+        if (now == ways[index(r, c)])
+          continue;
+        ways[index(r, c)] = now;
+        first = std::min(first, c);
+        last = c;
+      }
+      if (last < 0)
+        return;
+      lo = first - 1;
+      hi = last + 1;
+    }
+  }
+};
+
+// Answers for every start cell at once, built bottom-up in one pass.
+// timelinesFrom(r, c) is the number of timelines of a beam entering (r, c) and
+// splitsFrom(r, c) the number of distinct splitters it hits, both O(1) lookups.
+// The table is immutable once built, so one instance can be shared read-only by
+// any number of threads (e.g. through a shared_ptr<const TimelineTable>).
+//
+// Timelines cost O(rows * cols) to build. Distinct splitters don't add up along
+// the paths, so each splitter gets the set of splitters below it that it reaches,
+// as a bitset over splitter ids. That is O(splitters^2 / 64) time, processed in
+// blocks of SPLIT_BLOCK ids so memory stays O(splitters * SPLIT_BLOCK / 8).
+template <typename Counter = unsigned long long>
+class TimelineTable
+{
+public:
+  static const int SPLIT_BLOCK = 4096;
+
+  explicit TimelineTable(const Grid &grid) : rows(grid.rows), cols(grid.cols), width(grid.cols + 2)
+  {
+    buildTimelines(grid);
+    buildSplits(grid);
+  }
+
+  Counter timelinesFrom(int r, int c) const
+  {
+    if (r < 0 || c < 0 || c >= cols)
+      return Counter();
+    if (r >= rows)
+      return Counter(1);
+    return ways[(size_t)r * width + c + 1];
+  }
+
+  int splitsFrom(int r, int c) const
+  {
+    if (r < 0 || r >= rows || c < 0 || c >= cols)
+      return 0;
+    return splits[(size_t)r * cols + c];
+  }
+
+  // Batched forms, out[i] answers cells[i]
+  void timelinesFrom(const std::pair<int, int> *cells, size_t count, Counter *out) const
+  {
+    for (size_t i = 0; i < count; i++)
+      out[i] = timelinesFrom(cells[i].first, cells[i].second);
+  }
+
+  void splitsFrom(const std::pair<int, int> *cells, size_t count, int *out) const
+  {
+    for (size_t i = 0; i < count; i++)
+      out[i] = splitsFrom(cells[i].first, cells[i].second);
+  }
+
+private:
+  int rows, cols, width;
+  std::vector<Counter> ways; // padded, column c at index c + 1
+  std::vector<int> splits;
+
+  void buildTimelines(const Grid &grid)
+  {
+    ways.assign((size_t)(rows + 1) * width, Counter());
+    Counter *bottom = ways.data() + (size_t)rows * width;
+    for (int c = 0; c < cols; c++)
+      bottom[c + 1] = Counter(1);
+
+    for (int r = rows - 1; r >= 0; r--)
+    {
+      const Counter *below = ways.data() + (size_t)(r + 1) * width;
+      Counter *current = ways.data() + (size_t)r * width;
+      sweepRow(grid.row(r), below, current, cols);
+    }
+  }
+
+  void buildSplits(const Grid &grid)
+  {
+    // first[c] is the id of the first splitter at or below the current row in
+    // column c (-1 if none), ids are handed out from the bottom row upwards
+    std::vector<int> first(cols + 2, -1);
+    std::vector<std::pair<int, int>> children; // first splitters hit by the two split beams
+    int count = 0;
+    std::vector<int> firstAt((size_t)rows * cols);
+
+    for (int r = rows - 1; r >= 0; r--)
+    {
+      const char *line = grid.row(r);
+      for (int c = 0; c < cols; c++)
+      {
+        if (line[c] != '^')
+          continue;
+        children.push_back({first[c], first[c + 2]}); // still the row below here
+      }
+      for (int c = 0; c < cols; c++)
+      {
+        if (line[c] != '^')
+          continue;
+        first[c + 1] = count++;
+      }
+      std::copy(first.begin() + 1, first.end() - 1, firstAt.begin() + (size_t)r * cols);
+    }
+
+    std::vector<int> reached(count, 0);
+    int words = SPLIT_BLOCK / 64;
+    std::vector<unsigned long long> sets;
+
+    for (int lo = 0; lo < count; lo += SPLIT_BLOCK)
+    {
+      int hi = std::min(count, lo + SPLIT_BLOCK);
+      // splitters below id lo sit in the same row as lo or lower and can't
+      // reach anything in this block, so only ids from lo up need a set
+      sets.assign((size_t)(count - lo) * words, 0);
+      for (int id = lo; id < count; id++)
+      {
+        unsigned long long *set = sets.data() + (size_t)(id - lo) * words;
+        if (id < hi)
+          set[(id - lo) / 64] |= 1ULL << ((id - lo) % 64);
+        for (int child : {children[id].first, children[id].second})
+        {
+          if (child < lo)
+            continue;
+          const unsigned long long *childSet = sets.data() + (size_t)(child - lo) * words;
+          for (int w = 0; w < words; w++)
+            set[w] |= childSet[w];
+        }
+        for (int w = 0; w < words; w++)
+          reached[id] += __builtin_popcountll(set[w]);
+      }
+    }
+
+    splits.resize((size_t)rows * cols);
+    for (size_t i = 0; i < splits.size(); i++)
+      splits[i] = firstAt[i] < 0 ? 0 : reached[firstAt[i]];
+  }
+};
+
+// Several emitters solved together
+// Part 1 counts the splitters hit by the union of all beams, Part 2 the
+// timelines of every source and their total. Each part is one sweep over the
+// grid however many sources there are: Part 1 top-down with every source joining
+// the beam bitset when the sweep reaches its row, Part 2 bottom-up reading each
+// source's count off the row it sits in. A source on a '^' splits right away.
+template <typename Counter = unsigned long long>
+struct MultiSourceResult
+{
+  int splits = 0;
+  std::vector<std::pair<int, int>> sources;
+  std::vector<Counter> timelines; // per source, same order as sources
+  Counter total = Counter();
+};
+
+template <typename Counter = unsigned long long>
+MultiSourceResult<Counter> solveSources(const Grid &grid, const std::vector<std::pair<int, int>> &sources)
+{
+  MultiSourceResult<Counter> result;
+  result.sources = sources;
+  result.timelines.assign(sources.size(), Counter());
+  if (sources.empty())
+    return result;
+
+  int rows = grid.rows;
+  int cols = grid.cols;
+
+  // sources grouped by row, as indices into sources
+  std::vector<size_t> order(sources.size());
+  for (size_t i = 0; i < order.size(); i++)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+            { return sources[a].first < sources[b].first; });
+  int firstRow = sources[order.front()].first;
+
+  // Part 1, top-down
+  BeamFront front(cols);
+  size_t next = 0;
+  for (int r = firstRow; r < rows; r++)
+  {
+    for (; next < order.size() && sources[order[next]].first == r; next++)
+      front.add(sources[order[next]].second);
+    result.splits += front.advance(grid.row(r));
+  }
+
+  // Part 2, bottom-up
+  std::vector<Counter> below(cols + 2, Counter(1)), current(cols + 2);
+  below[0] = below[cols + 1] = Counter();
+  size_t pending = order.size();
+  for (int r = rows - 1; r >= firstRow; r--)
+  {
+    sweepRow(grid.row(r), below.data(), current.data(), cols);
+    std::swap(below, current);
+
+    for (; pending > 0 && sources[order[pending - 1]].first == r; pending--)
+    {
+      size_t i = order[pending - 1];
+      result.timelines[i] = below[sources[i].second + 1];
+      result.total = result.total + result.timelines[i];
+    }
+  }
+
+  return result;
+}
+
+template <typename Counter = unsigned long long>
+MultiSourceResult<Counter> solveSources(const Grid &grid)
+{
+  return solveSources<Counter>(grid, findSources(grid));
+}
+
+// Observers as compile-time policies
+// The solvers call observer(...) with the Part1Callback / Part2Callback arguments
+// on every step. Any callable works and gets inlined; NullObserver compiles down
+// to the bare loop. The std::function entry points wrap these.
+struct NullObserver
+{
+  template <typename... Args>
+  void operator()(Args &&...) const {}
+};
+
+template <typename Observer>
+int solpart1Observed(const Grid &grid, Observer &&observer)
+{
+  int rows = grid.rows;
+
+  // Find start position 'S'
+  int startRow = -1, startCol = -1;
+  if (!findStart(grid, startRow, startCol))
+    return 0;
+
   // BFS
   std::queue<Beam> beams;
-  std::set<std::pair<int, int>> visitedSplitters; // track which splitters have been hit
+  SplitterBitmap visitedSplitters(rows, grid.cols); // track which splitters have been hit
 
   // start beam moving down from S
   beams.push({startRow, startCol, startRow, startCol}); // Start from itself effectively
+  SOLVER_STAT(stats.beamsEnqueued++);
 
   int splitCount = 0; // count how many times beams are split
 
@@ -81,27 +860,30 @@ int solpart1(const std::vector<std::string> &grid, Part1Callback callback)
     int from_c = current.from_c;
 
     // move downward until we hit a splitter or exit the grid
-    while (r >= 0 && r < rows && c >= 0 && c < cols)
+    while (r < rows)
     {
-      if (callback)
-        callback(r, c, from_r, from_c, visitedSplitters);
+      char cell = grid.at(r, c);
+      if (cell == GRID_PAD)
+        break; // split off the side of the grid
 
-      char cell = grid[r][c];
+      observer(r, c, from_r, from_c, visitedSplitters);
+      SOLVER_STAT(stats.cellsStepped++);
 
       if (cell == '^')
       {
         // check if this splitter was already hit
-        auto splitterPos = std::make_pair(r, c);
-        if (visitedSplitters.count(splitterPos) == 0)
+        if (visitedSplitters.insert(r, c))
         {
-          visitedSplitters.insert(splitterPos);
           splitCount++; // count this split
 
           // create two new beams from immediate left and right, going down
           // Connection is from (r, c) to (r+1, c-1) and (r+1, c+1)
           beams.push({r + 1, c - 1, r, c}); // left beam continues down
           beams.push({r + 1, c + 1, r, c}); // right beam continues down
+          SOLVER_STAT(stats.beamsEnqueued += 2);
         }
+        else
+          SOLVER_STAT(stats.duplicateSplitterHits++);
         break; // this beam stops at the splitter
       }
 
@@ -116,95 +898,1196 @@ int solpart1(const std::vector<std::string> &grid, Part1Callback callback)
 }
 
 // Helper for Part 2 DFS
+template <typename Observer>
 long long countPathsRecursive(int r, int c, int from_r, int from_c, int rows, int cols,
-                              const std::vector<std::string> &grid,
+                              const Grid &grid,
                               std::map<std::pair<int, int>, long long> &memo,
-                              Part2Callback callback)
+                              Observer &observer)
 {
-
-  // Check bounds
-  if (c < 0 || c >= cols)
-    return 0;
+  // Check bounds, the padding catches beams split off the side
   if (r >= rows)
-    return 1; // Reached bottom successfully
+    return c >= 0 && c < cols; // Reached bottom successfully
+  char cell = grid.at(r, c);
+  if (cell == GRID_PAD)
+    return 0;
 
   // Check memo
-  if (memo.count({r, c}))
+  auto known = memo.find({r, c});
+  if (known != memo.end())
   {
-    if (callback)
-      callback(r, c, from_r, from_c, DFS_MEMO_HIT, memo[{r, c}]);
-    return memo[{r, c}];
+    SOLVER_STAT(stats.memoHits++);
+    observer(r, c, from_r, from_c, DFS_MEMO_HIT, known->second);
+    return known->second;
   }
 
-  if (callback)
-    callback(r, c, from_r, from_c, DFS_VISIT, 0);
+  observer(r, c, from_r, from_c, DFS_VISIT, 0);
+  SOLVER_STAT(stats.memoMisses++; stats.cellsStepped++);
+#ifdef SOLVER_STATS
+  SolverDepthGuard depth;
+#endif
 
   long long result = 0;
-  char cell = grid[r][c];
 
   if (cell == '^')
   {
     // Splitter: sum paths from left and right
-    result = countPathsRecursive(r + 1, c - 1, r, c, rows, cols, grid, memo, callback) +
-             countPathsRecursive(r + 1, c + 1, r, c, rows, cols, grid, memo, callback);
+    result = countPathsRecursive(r + 1, c - 1, r, c, rows, cols, grid, memo, observer) +
+             countPathsRecursive(r + 1, c + 1, r, c, rows, cols, grid, memo, observer);
   }
   else
   {
     // Continue straight down
-    result = countPathsRecursive(r + 1, c, r, c, rows, cols, grid, memo, callback);
+    result = countPathsRecursive(r + 1, c, r, c, rows, cols, grid, memo, observer);
   }
 
   memo[{r, c}] = result;
-  if (callback)
-    callback(r, c, from_r, from_c, DFS_RETURN, result);
+  SOLVER_STAT(stats.peakMemoSize = std::max(stats.peakMemoSize, memo.size()));
+  observer(r, c, from_r, from_c, DFS_RETURN, result);
   return result;
 }
 
-// Part 2: Count all possible timelines (paths) through the manifold
 // REWRITTEN: Recursive DFS with Memoization
-long long solpart2(const std::vector<std::string> &grid, Part2Callback callback)
+template <typename Observer>
+long long solpart2Observed(const Grid &grid, Observer &&observer)
 {
-  int rows = grid.size();
-  int cols = rows > 0 ? grid[0].size() : 0;
+  int rows = grid.rows;
+  int cols = grid.cols;
 
   // Find start position 'S'
   int startRow = -1, startCol = -1;
-  for (int r = 0; r < rows; r++)
-  {
-    for (int c = 0; c < cols; c++)
-    {
-      if (grid[r][c] == 'S')
+  if (!findStart(grid, startRow, startCol))
+    return 0;
+
+  std::map<std::pair<int, int>, long long> memo;
+  // Start from S, no previous node really, so use S itself
+  return countPathsRecursive(startRow, startCol, startRow, startCol, rows, cols, grid, memo, observer);
+}
+
+// Bounded single-producer single-consumer queue.
+// Exactly one thread pushes and one other thread pops; neither ever takes a lock,
+// push fails when the ring is full and pop when it is empty.
+template <typename T>
+class SpscRing
+{
+public:
+  // capacity is rounded up to a power of two
+  explicit SpscRing(size_t capacity)
+  {
+    size_t size = 1;
+    while (size < capacity)
+      size *= 2;
+    slots.resize(size);
+    mask = size - 1;
+  }
+
+  bool push(const T &item)
+  {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) > mask)
+      return false;
+    slots[t & mask] = item;
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T &item)
+  {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire))
+      return false;
+    item = slots[h & mask];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consumer side, true if nothing is waiting to be popped
+  bool empty() const
+  {
+    return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+  }
+
+private:
+  std::vector<T> slots;
+  size_t mask = 0;
+  alignas(64) std::atomic<size_t> head{0}; // next slot to pop, written by the consumer
+  alignas(64) std::atomic<size_t> tail{0}; // next slot to push, written by the producer
+};
+
+// Solver events as recorded in a trace
+enum TraceEventKind : unsigned char
+{
+  TRACE_BEAM_STEP,    // Part 1 BFS stepped onto (r, c)
+  TRACE_DFS_VISIT,    // the DFSAction values, shifted by one
+  TRACE_DFS_MEMO_HIT,
+  TRACE_DFS_RETURN
+};
+
+struct TraceEvent
+{
+  TraceEventKind kind = TRACE_BEAM_STEP;
+  int r = 0, c = 0;
+  int from_r = 0, from_c = 0;
+  long long value = 0; // memo hits and returns only
+};
+
+// Trace file format, all integers little endian:
+//   header  "D7TRACE" '\0', u32 version, u32 rows, u32 cols
+//   events  kind byte, then zigzag varints of r and c relative to the previous
+//           event and of from_r, from_c relative to (r, c); memo hits and
+//           returns add their value as one more zigzag varint
+// Consecutive events are almost always neighbours, so most take 5 bytes.
+const unsigned TRACE_VERSION = 1;
+
+// Streams solver events to a trace file.
+// Usable directly as the observer of solpart1Observed and solpart2Observed: the
+// solver only copies each event into a preallocated ring, a writer thread encodes
+// and writes them. When the ring is full the solver waits for the writer, a trace
+// never drops events.
+class TraceRecorder
+{
+public:
+  TraceRecorder() : ring(1 << 16) {}
+  ~TraceRecorder() { close(); }
+
+  // Create path and write the header, false with error filled if it can't be written
+  bool open(const std::string &path, int rows, int cols, std::string &error);
+  // Flush everything recorded so far and close the file, false if a write failed
+  bool close();
+  size_t events() const { return recorded; }
+
+  void record(const TraceEvent &event)
+  {
+    while (!ring.push(event))
+      std::this_thread::yield();
+    recorded++;
+  }
+
+  void operator()(int r, int c, int from_r, int from_c, const SplitterView &)
+  {
+    record({TRACE_BEAM_STEP, r, c, from_r, from_c, 0});
+  }
+  void operator()(int r, int c, int from_r, int from_c, DFSAction action, long long value)
+  {
+    record({(TraceEventKind)(TRACE_DFS_VISIT + action), r, c, from_r, from_c, value});
+  }
+
+private:
+  void writeLoop();
+
+  SpscRing<TraceEvent> ring;
+  std::FILE *file = nullptr;
+  std::thread writer;
+  std::atomic<bool> stopping{false};
+  bool failed = false;
+  size_t recorded = 0;
+};
+
+// Reads a trace back event by event
+class TraceReader
+{
+public:
+  ~TraceReader();
+
+  // Open path and check its header, false with error filled if it is not a trace
+  bool open(const std::string &path, std::string &error);
+  // False at the end of the trace or on a truncated event
+  bool next(TraceEvent &event);
+
+  int rows = 0;
+  int cols = 0;
+
+private:
+  bool readVarint(unsigned long long &value);
+
+  std::FILE *file = nullptr;
+  int lastR = 0, lastC = 0;
+};
+
+#endif // RESULT_H
+
+#ifdef RESULT_IMPLEMENTATION
+Grid::Grid(const std::vector<std::string> &lines)
+{
+  rows = lines.size();
+  cols = rows > 0 ? lines[0].size() : 0;
+  stride = cols + 1;
+
+  size_t size = 1 + (size_t)rows * stride;
+  char *buffer = new char[size];
+  storage.reset(buffer, std::default_delete<char[]>());
+  cells = buffer + 1;
+
+  buffer[0] = GRID_PAD;
+  for (int r = 0; r < rows; r++)
+  {
+    char *dst = buffer + 1 + (size_t)r * stride;
+    size_t n = std::min<size_t>(cols, lines[r].size());
+    memcpy(dst, lines[r].data(), n);
+    memset(dst + n, '.', cols - n);
+    dst[cols] = GRID_PAD;
+  }
+}
+
+// The file is mapped one page into a reserved region, which leaves the byte in
+// front of it for the leading pad and room behind it for a missing final newline.
+// The mapping is private, so writing those two bytes never touches the file.
+bool loadGrid(const std::string &path, Grid &grid, std::string &error)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    error = "Failed to open " + path;
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0)
+  {
+    close(fd);
+    error = "Failed to stat " + path;
+    return false;
+  }
+
+  size_t size = info.st_size;
+  if (size == 0)
+  {
+    close(fd);
+    grid = Grid();
+    return true;
+  }
+
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t mapped = (size + page - 1) / page * page;
+  size_t total = page + mapped + page;
+
+  char *region = (char *)mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (region == MAP_FAILED)
+  {
+    close(fd);
+    error = "Failed to reserve memory for " + path;
+    return false;
+  }
+  char *data = (char *)mmap(region + page, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    munmap(region, total);
+    error = "Failed to map " + path;
+    return false;
+  }
+  madvise(data, size, MADV_SEQUENTIAL);
+  std::shared_ptr<const char> storage(region, [total](const char *p)
+                                      { munmap((void *)p, total); });
+
+  // ignore blank lines at the end of the file, LF or CRLF
+  for (;;)
+  {
+    if (size > 1 && data[size - 1] == '\n' && data[size - 2] == '\n')
+      size--;
+    else if (size > 3 && memcmp(data + size - 4, "\r\n\r\n", 4) == 0)
+      size -= 2;
+    else
+      break;
+  }
+
+  const char *newline = (const char *)memchr(data, '\n', size);
+  size_t cols = newline ? newline - data : size;
+  if (cols > 0 && data[cols - 1] == '\r')
+  {
+    // CRLF, copy the rows without their carriage returns
+    std::vector<std::string> lines;
+    for (const char *p = data, *end = data + size; p < end;)
+    {
+      const char *eol = (const char *)memchr(p, '\n', end - p);
+      const char *next = eol ? eol + 1 : end;
+      if (!eol)
+        eol = end;
+      if (eol > p && eol[-1] == '\r')
+        eol--;
+      if ((size_t)(eol - p) != cols - 1)
       {
-        startRow = r;
-        startCol = c;
-        break;
+        error = path + ": row " + std::to_string(lines.size() + 1) + " has a different width";
+        return false;
       }
+      lines.emplace_back(p, eol);
+      p = next;
     }
-    if (startRow != -1)
+    grid = Grid(lines);
+    return true;
+  }
+
+  size_t stride = cols + 1;
+  if (data[size - 1] != '\n')
+    data[size++] = '\n'; // last row without newline, the byte after it is ours
+  if (size % stride != 0)
+  {
+    error = path + ": rows have different widths";
+    return false;
+  }
+  region[page - 1] = GRID_PAD;
+
+  // every row must end exactly at its newline, one memchr per row covers each byte once
+  size_t rows = size / stride;
+  for (size_t r = 0; r < rows; r++)
+  {
+    const char *row = data + r * stride;
+    if (row[cols] != '\n' || memchr(row, '\n', cols) != nullptr)
+    {
+      error = path + ": row " + std::to_string(r + 1) + " has a different width";
+      return false;
+    }
+  }
+
+  grid.rows = rows;
+  grid.cols = cols;
+  grid.stride = stride;
+  grid.cells = data;
+  grid.storage = storage;
+  return true;
+}
+
+// Locate the first 'S' in row-major order, returns false if there is none
+bool findStart(const Grid &grid, int &startRow, int &startCol)
+{
+#ifdef SOLVER_STATS
+  SolverPhaseTimer timer(solverStats().locateSeconds);
+#endif
+  if (grid.rows == 0)
+    return false;
+
+  size_t size = (size_t)grid.rows * grid.stride;
+  const char *hit = (const char *)memchr(grid.cells, 'S', size);
+  if (!hit)
+    return false;
+
+  size_t offset = hit - grid.cells;
+  startRow = offset / grid.stride;
+  startCol = offset % grid.stride;
+  return true;
+}
+
+std::vector<std::pair<int, int>> findSources(const Grid &grid)
+{
+  std::vector<std::pair<int, int>> sources;
+  const char *begin = grid.cells;
+  const char *end = grid.cells + (size_t)grid.rows * grid.stride;
+  for (const char *p = begin; p < end; p++)
+  {
+    p = (const char *)memchr(p, 'S', end - p);
+    if (!p)
       break;
+    sources.push_back({(int)((p - begin) / grid.stride), (int)((p - begin) % grid.stride)});
   }
+  return sources;
+}
 
-  std::map<std::pair<int, int>, long long> memo;
-  // Start from S, no previous node really, so use S itself
-  return countPathsRecursive(startRow, startCol, startRow, startCol, rows, cols, grid, memo, callback);
+int solpart1(const Grid &grid, Part1Callback callback)
+{
+  if (callback)
+    return solpart1Observed(grid, callback);
+  return solpart1Observed(grid, NullObserver());
+}
+
+// Part 1: Bitset
+// Each splitter sits in exactly one row, so counting the hits row by row never
+// counts a splitter twice.
+int solpart1Bitset(const Grid &grid)
+{
+  int rows = grid.rows;
+  int cols = grid.cols;
+
+  int startRow = -1, startCol = -1;
+  if (!findStart(grid, startRow, startCol))
+    return 0;
+
+  BeamFront front(cols);
+  front.add(startCol);
+
+  int splitCount = 0;
+  int r = startRow;
+  for (; r < rows && !front.empty(); r++)
+    splitCount += front.advance(grid.row(r));
+  SOLVER_STAT(stats.cellsStepped += (long long)(r - startRow) * cols);
+
+  return splitCount;
+}
+
+BeamFront::BeamFront(int cols) : cols(cols), words((cols + 63) / 64), first(words), last(0), splitterMask(splitterMaskKernel()), active(words, 0), splitters(words, 0), hits(words, 0)
+{
+  lastMask = cols % 64 ? (1ULL << (cols % 64)) - 1 : ~0ULL;
+}
+
+void BeamFront::add(int c)
+{
+  active[c / 64] |= 1ULL << (c % 64);
+  first = std::min(first, c / 64);
+  last = std::max(last, c / 64 + 1);
+}
+
+bool BeamFront::empty() const
+{
+  return first >= last;
+}
+
+int BeamFront::advance(const char *line)
+{
+  int hitCount = 0;
+  if (empty())
+    return 0;
+
+  // beams move at most one word, hits outside [from, to) are zero this row
+  int from = std::max(first - 1, 0);
+  int to = std::min(last + 1, words);
+
+  // only the words under a beam need their splitter mask
+  for (int w = from; w < to; w++)
+  {
+    unsigned long long mask = active[w] ? splitterMask(line + w * 64, std::min(64, cols - w * 64)) : 0;
+    splitters[w] = mask;
+    hits[w] = active[w] & mask;
+    hitCount += __builtin_popcountll(hits[w]);
+  }
+
+  for (int w = from; w < to; w++)
+  {
+    unsigned long long left = hits[w] >> 1 | (w + 1 < to ? hits[w + 1] << 63 : 0);
+    unsigned long long right = hits[w] << 1 | (w > from ? hits[w - 1] >> 63 : 0);
+    active[w] = (active[w] & ~splitters[w]) | left | right;
+  }
+  active[words - 1] &= lastMask;
+
+  first = from;
+  last = to;
+  while (first < last && !active[first])
+    first++;
+  while (last > first && !active[last - 1])
+    last--;
+
+  return hitCount;
+}
+
+int solpart1(const Grid &grid, Part1Engine engine)
+{
+  if (engine == PART1_BITSET)
+    return solpart1Bitset(grid);
+  return solpart1(grid);
+}
+
+// Part 2: Count all possible timelines (paths) through the manifold
+// Only the DFS reports callbacks, without one the sweep gives the same count faster
+long long solpart2(const Grid &grid, Part2Callback callback)
+{
+  if (callback)
+    return solpart2Dfs(grid, callback);
+  return solpart2Sweep(grid);
+}
+
+long long solpart2Dfs(const Grid &grid, Part2Callback callback)
+{
+  if (callback)
+    return solpart2Observed(grid, callback);
+  return solpart2Observed(grid, NullObserver());
+}
+
+long long solpart2Sweep(const Grid &grid)
+{
+  // wrapping 64-bit counts give the exact answer whenever it fits
+  return (long long)countTimelines<unsigned long long>(grid);
+}
+
+long long solpart2(const Grid &grid, Part2Engine engine)
+{
+  if (engine == PART2_DFS)
+    return solpart2Dfs(grid, nullptr);
+  return solpart2Sweep(grid);
+}
+
+#ifdef SWEEP_X86_KERNELS
+// The vector kernels read the three neighbours as unaligned loads at offsets 0, 1
+// and 2 of the padded row and turn the '^' bytes into full 64-bit lane masks.
+__attribute__((target("avx2"))) void sweepRowAvx2(const char *row, const unsigned long long *below, unsigned long long *current, int cols)
+{
+  const __m128i splitter = _mm_set1_epi8('^');
+  int c = 0;
+  for (; c + 4 <= cols; c += 4)
+  {
+    int bytes;
+    memcpy(&bytes, row + c, sizeof(bytes));
+    __m256i mask = _mm256_cvtepi8_epi64(_mm_cmpeq_epi8(_mm_cvtsi32_si128(bytes), splitter));
+    __m256i left = _mm256_loadu_si256((const __m256i *)(below + c));
+    __m256i down = _mm256_loadu_si256((const __m256i *)(below + c + 1));
+    __m256i right = _mm256_loadu_si256((const __m256i *)(below + c + 2));
+    __m256i split = _mm256_add_epi64(left, right);
+    _mm256_storeu_si256((__m256i *)(current + c + 1), _mm256_blendv_epi8(down, split, mask));
+  }
+  sweepRowScalar(row + c, below + c, current + c, cols - c);
+}
+
+__attribute__((target("avx512f"))) void sweepRowAvx512(const char *row, const unsigned long long *below, unsigned long long *current, int cols)
+{
+  const __m128i splitter = _mm_set1_epi8('^');
+  int c = 0;
+  for (; c + 8 <= cols; c += 8)
+  {
+    __m128i bytes = _mm_loadl_epi64((const __m128i *)(row + c));
+    __mmask8 mask = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, splitter)) & 0xFF;
+    __m512i left = _mm512_loadu_si512(below + c);
+    __m512i down = _mm512_loadu_si512(below + c + 1);
+    __m512i right = _mm512_loadu_si512(below + c + 2);
+    __m512i split = _mm512_add_epi64(left, right);
+    _mm512_storeu_si512(current + c + 1, _mm512_mask_blend_epi64(mask, down, split));
+  }
+  sweepRowScalar(row + c, below + c, current + c, cols - c);
+}
+#endif
+
+unsigned long long splitterMaskScalar(const char *line, int count)
+{
+  unsigned long long mask = 0;
+  for (int i = 0; i < count; i++)
+    mask |= (unsigned long long)(line[i] == '^') << i;
+  return mask;
+}
+
+#ifdef SWEEP_X86_KERNELS
+// A full word is two byte compares and two movemasks, a partial last word goes scalar
+__attribute__((target("avx2"))) unsigned long long splitterMaskAvx2(const char *line, int count)
+{
+  if (count < 64)
+    return splitterMaskScalar(line, count);
+  const __m256i splitter = _mm256_set1_epi8('^');
+  __m256i low = _mm256_loadu_si256((const __m256i *)line);
+  __m256i high = _mm256_loadu_si256((const __m256i *)(line + 32));
+  unsigned lowMask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(low, splitter));
+  unsigned highMask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(high, splitter));
+  return (unsigned long long)highMask << 32 | lowMask;
 }
 #endif
 
-#ifndef VISUALIZATION_MODE
-int main()
+SplitterMaskKernel splitterMaskKernel()
 {
-  std::ifstream file("input/input.txt");
+  static const SplitterMaskKernel kernel = []() -> SplitterMaskKernel
+  {
+#ifdef SWEEP_X86_KERNELS
+    if (__builtin_cpu_supports("avx2"))
+      return splitterMaskAvx2;
+#endif
+    return splitterMaskScalar;
+  }();
+  return kernel;
+}
+
+SweepRowKernel sweepRowKernel()
+{
+  static const SweepRowKernel kernel = []() -> SweepRowKernel
+  {
+#ifdef SWEEP_X86_KERNELS
+    if (__builtin_cpu_supports("avx512f"))
+      return sweepRowAvx512;
+    if (__builtin_cpu_supports("avx2"))
+      return sweepRowAvx2;
+#endif
+    return sweepRowScalar<unsigned long long>;
+  }();
+  return kernel;
+}
+
+static void putVarint(std::vector<unsigned char> &out, unsigned long long value)
+{
+  while (value >= 0x80)
+  {
+    out.push_back((unsigned char)(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back((unsigned char)value);
+}
+
+static void putZigzag(std::vector<unsigned char> &out, long long value)
+{
+  putVarint(out, ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63));
+}
+
+static void putU32(std::vector<unsigned char> &out, unsigned value)
+{
+  for (int i = 0; i < 4; i++)
+    out.push_back((unsigned char)(value >> (8 * i)));
+}
+
+bool TraceRecorder::open(const std::string &path, int rows, int cols, std::string &error)
+{
+  close();
+  file = std::fopen(path.c_str(), "wb");
+  if (!file)
+  {
+    error = "Failed to create " + path;
+    return false;
+  }
+
+  std::vector<unsigned char> header(8);
+  memcpy(header.data(), "D7TRACE", 8);
+  putU32(header, TRACE_VERSION);
+  putU32(header, rows);
+  putU32(header, cols);
+  if (std::fwrite(header.data(), 1, header.size(), file) != header.size())
+  {
+    std::fclose(file);
+    file = nullptr;
+    error = "Failed to write " + path;
+    return false;
+  }
+
+  failed = false;
+  recorded = 0;
+  stopping = false;
+  writer = std::thread(&TraceRecorder::writeLoop, this);
+  return true;
+}
+
+bool TraceRecorder::close()
+{
+  if (!file)
+    return true;
+  stopping = true;
+  writer.join();
+  if (std::fclose(file) != 0)
+    failed = true;
+  file = nullptr;
+  return !failed;
+}
+
+// Encode into a buffer and write it out in large chunks.
+// The ring is drained once more after stopping is seen, so nothing pushed before
+// close() is lost.
+void TraceRecorder::writeLoop()
+{
+  std::vector<unsigned char> buffer;
+  buffer.reserve(1 << 17);
+  int lastR = 0, lastC = 0;
+  TraceEvent event;
+  for (;;)
+  {
+    bool stop = stopping.load(std::memory_order_acquire);
+    while (ring.pop(event))
+    {
+      buffer.push_back(event.kind);
+      putZigzag(buffer, (long long)event.r - lastR);
+      putZigzag(buffer, (long long)event.c - lastC);
+      putZigzag(buffer, (long long)event.from_r - event.r);
+      putZigzag(buffer, (long long)event.from_c - event.c);
+      if (event.kind == TRACE_DFS_MEMO_HIT || event.kind == TRACE_DFS_RETURN)
+        putZigzag(buffer, event.value);
+      lastR = event.r;
+      lastC = event.c;
+
+      if (buffer.size() >= (1 << 16))
+      {
+        if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size())
+          failed = true;
+        buffer.clear();
+      }
+    }
+    if (stop)
+      break;
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  if (!buffer.empty() && std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size())
+    failed = true;
+}
+
+TraceReader::~TraceReader()
+{
+  if (file)
+    std::fclose(file);
+}
+
+bool TraceReader::open(const std::string &path, std::string &error)
+{
+  file = std::fopen(path.c_str(), "rb");
+  if (!file)
+  {
+    error = "Failed to open " + path;
+    return false;
+  }
+
+  unsigned char header[20];
+  if (std::fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, "D7TRACE", 8) != 0)
+  {
+    error = path + ": not a trace file";
+    return false;
+  }
+  auto u32 = [&](int at)
+  {
+    return (unsigned)header[at] | (unsigned)header[at + 1] << 8 | (unsigned)header[at + 2] << 16 | (unsigned)header[at + 3] << 24;
+  };
+  if (u32(8) != TRACE_VERSION)
+  {
+    error = path + ": unsupported trace version " + std::to_string(u32(8));
+    return false;
+  }
+  rows = u32(12);
+  cols = u32(16);
+  lastR = lastC = 0;
+  return true;
+}
+
+bool TraceReader::readVarint(unsigned long long &value)
+{
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7)
+  {
+    int byte = std::fgetc(file);
+    if (byte == EOF)
+      return false;
+    value |= (unsigned long long)(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+bool TraceReader::next(TraceEvent &event)
+{
+  if (!file)
+    return false;
+  int kind = std::fgetc(file);
+  if (kind == EOF || kind > TRACE_DFS_RETURN)
+    return false;
+
+  long long fields[5] = {0, 0, 0, 0, 0};
+  int count = kind == TRACE_DFS_MEMO_HIT || kind == TRACE_DFS_RETURN ? 5 : 4;
+  for (int i = 0; i < count; i++)
+  {
+    unsigned long long raw;
+    if (!readVarint(raw))
+      return false;
+    fields[i] = (long long)(raw >> 1) ^ -(long long)(raw & 1);
+  }
+
+  event.kind = (TraceEventKind)kind;
+  event.r = lastR + fields[0];
+  event.c = lastC + fields[1];
+  event.from_r = event.r + fields[2];
+  event.from_c = event.c + fields[3];
+  event.value = fields[4];
+  lastR = event.r;
+  lastC = event.c;
+  return true;
+}
+#endif
+
+#if !defined(VISUALIZATION_MODE) && !defined(BENCHMARK_MODE)
+// Bounded FIFO between the batch loader and the workers.
+// pop returns false once the queue is closed and drained.
+template <typename T>
+class BlockingQueue
+{
+public:
+  explicit BlockingQueue(size_t capacity) : capacity(capacity) {}
+
+  void push(T item)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    notFull.wait(lock, [this]
+                 { return items.size() < capacity; });
+    items.push(std::move(item));
+    notEmpty.notify_one();
+  }
+
+  bool pop(T &item)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    notEmpty.wait(lock, [this]
+                  { return !items.empty() || closed; });
+    if (items.empty())
+      return false;
+    item = std::move(items.front());
+    items.pop();
+    notFull.notify_one();
+    return true;
+  }
+
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    notEmpty.notify_all();
+  }
+
+private:
+  size_t capacity;
+  std::queue<T> items;
+  bool closed = false;
+  std::mutex mutex;
+  std::condition_variable notEmpty, notFull;
+};
+
+// Part 2 as selected on the command line, formatted for printing
+using Part2Solver = std::function<std::string(const Grid &grid)>;
+
+Part2Solver makePart2Solver(Part2Engine engine, const std::string &counter)
+{
+  if (counter.empty())
+    return [engine](const Grid &grid)
+    { return std::to_string(solpart2(grid, engine)); };
+  if (counter == "u64")
+    return [](const Grid &grid)
+    { return toString(countTimelines<unsigned long long>(grid)); };
+  if (counter == "u128")
+    return [](const Grid &grid)
+    { return toString(countTimelines<unsigned __int128>(grid)); };
+  if (counter == "big")
+    return [](const Grid &grid)
+    { return toString(countTimelines<BigCounter<4>>(grid)); };
+  if (counter == "mod")
+    return [](const Grid &grid)
+    { return toString(countTimelines<ModCounter<1000000007>>(grid)) + " (mod 1000000007)"; };
+  return nullptr;
+}
+
+#ifdef SOLVER_STATS
+// One part's counters as a JSON object, solve_ms includes locate_ms
+void printStatsJson(std::ostream &out, const SolverStats &stats, double solveSeconds)
+{
+  out << "{\"locate_ms\": " << stats.locateSeconds * 1e3
+      << ", \"solve_ms\": " << solveSeconds * 1e3
+      << ", \"cells_stepped\": " << stats.cellsStepped
+      << ", \"beams_enqueued\": " << stats.beamsEnqueued
+      << ", \"duplicate_splitter_hits\": " << stats.duplicateSplitterHits
+      << ", \"memo_hits\": " << stats.memoHits
+      << ", \"memo_misses\": " << stats.memoMisses
+      << ", \"peak_memo_size\": " << stats.peakMemoSize
+      << ", \"max_recursion_depth\": " << stats.maxRecursionDepth << "}";
+}
+#endif
+
+// Print a recorded trace one event per line
+int dumpTrace(const std::string &path)
+{
+  TraceReader reader;
+  std::string error;
+  if (!reader.open(path, error))
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+
+  static const char *const names[] = {"beam", "visit", "memo", "return"};
+  std::cout << "grid " << reader.rows << "x" << reader.cols << '\n';
+  TraceEvent event;
+  while (reader.next(event))
+  {
+    std::cout << names[event.kind] << ' ' << event.r << ' ' << event.c << " from " << event.from_r << ' ' << event.from_c;
+    if (event.kind == TRACE_DFS_MEMO_HIT || event.kind == TRACE_DFS_RETURN)
+      std::cout << " = " << event.value;
+    std::cout << '\n';
+  }
+  return 0;
+}
+
+// Grid files named by a batch argument: every regular file of a directory in
+// name order, or one path per line of a manifest, relative to the manifest
+bool listBatch(const std::string &source, std::vector<std::string> &paths, std::string &error)
+{
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  if (fs::is_directory(source, ec))
+  {
+    for (fs::directory_iterator it(source, ec), end; !ec && it != end; it.increment(ec))
+    {
+      if (it->is_regular_file())
+        paths.push_back(it->path().string());
+    }
+    if (ec)
+    {
+      error = "Failed to list " + source + ": " + ec.message();
+      return false;
+    }
+    std::sort(paths.begin(), paths.end());
+    return true;
+  }
+
+  std::ifstream manifest(source);
+  if (!manifest.is_open())
+  {
+    error = "Failed to open " + source;
+    return false;
+  }
+  fs::path base = fs::path(source).parent_path();
   std::string line;
-  std::vector<std::string> grid;
+  while (std::getline(manifest, line))
+  {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    if (line.empty())
+      continue;
+    fs::path path(line);
+    paths.push_back(path.is_absolute() ? line : (base / path).string());
+  }
+  return true;
+}
+
+// Stream rows from in through a StreamingSolver and print both parts
+template <typename Counter>
+int runStream(std::istream &in, const std::string &suffix)
+{
+  StreamingSolver<Counter> solver;
+  std::string line;
+  while (std::getline(in, line))
+  {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    if (line.empty())
+      continue;
+    if (!solver.pushRow(line))
+    {
+      std::cerr << "Row " << solver.rowsSeen() + 1 << " has a different width" << std::endl;
+      return 1;
+    }
+  }
+
+  std::cout << "Part 1 - Total splits: " << solver.splits() << std::endl;
+  std::cout << "Part 2 - Total timelines: " << toString(solver.timelines()) << suffix << std::endl;
+  return 0;
+}
+
+struct BatchJob
+{
+  size_t index = 0;
+  std::string path;
+  Grid grid;
+  std::string error;
+};
+
+// Solve every grid on a fixed pool of workers.
+// A loader thread maps the files in input order and hands them over through a
+// bounded queue, so I/O for the next grids overlaps with solving the current ones
+// and at most a few grids are resident. Results are printed in input order as
+// soon as everything before them is done.
+void runBatch(const std::vector<std::string> &paths, int workers, Part1Engine engine1, const Part2Solver &part2)
+{
+  BlockingQueue<BatchJob> queue(2 * workers);
+  std::vector<std::string> results(paths.size());
+  std::vector<bool> done(paths.size(), false);
+  std::mutex resultsMutex;
+  std::condition_variable resultReady;
+
+  std::thread loader([&]
+                     {
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+      BatchJob job;
+      job.index = i;
+      job.path = paths[i];
+      loadGrid(job.path, job.grid, job.error);
+      queue.push(std::move(job));
+    }
+    queue.close(); });
+
+  std::vector<std::thread> pool;
+  for (int w = 0; w < workers; w++)
+  {
+    pool.emplace_back([&]
+                      {
+      BatchJob job;
+      while (queue.pop(job))
+      {
+        std::string result;
+        if (!job.error.empty())
+          result = job.error;
+        else
+          result = job.path + ": Part 1 - Total splits: " + std::to_string(solpart1(job.grid, engine1)) +
+                   ", Part 2 - Total timelines: " + part2(job.grid);
+        job.grid = Grid(); // unmap before waiting for the next one
+
+        {
+          std::lock_guard<std::mutex> lock(resultsMutex);
+          results[job.index] = std::move(result);
+          done[job.index] = true;
+        }
+        resultReady.notify_all();
+      } });
+  }
+
+  for (size_t i = 0; i < paths.size(); i++)
+  {
+    std::string result;
+    {
+      std::unique_lock<std::mutex> lock(resultsMutex);
+      resultReady.wait(lock, [&]
+                       { return done[i]; });
+      result = std::move(results[i]);
+    }
+    std::cout << result << '\n';
+  }
+  std::cout.flush();
+
+  loader.join();
+  for (auto &worker : pool)
+    worker.join();
+}
+
+int main(int argc, char *argv[])
+{
+  // --engine=bitset selects the row-parallel Part 1 engine, --engine=dfs the recursive Part 2 one
+  Part1Engine engine1 = PART1_BFS;
+  Part2Engine engine2 = PART2_ROW_SWEEP;
+  // --counter=u128|big|mod counts Part 2 with the sweep engine in a wider counter type,
+  // together with --engine=dfs it is an error
+  std::string counter;
+  // --batch <dir|manifest> solves many grids, --threads=N sizes the worker pool
+  std::string batch;
+  // --stream reads the grid from stdin row by row instead of input/input.txt
+  bool stream = false;
+  // --all-sources solves every 'S' together instead of the first one
+  bool allSources = false;
+  // --trace=path records every BFS and DFS event, --dump-trace=path prints a recorded trace
+  std::string tracePath, dumpPath;
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--engine=bitset")
+      engine1 = PART1_BITSET;
+    else if (arg == "--engine=bfs")
+      engine1 = PART1_BFS;
+    else if (arg == "--engine=sweep")
+      engine2 = PART2_ROW_SWEEP;
+    else if (arg == "--engine=dfs")
+      engine2 = PART2_DFS;
+    else if (arg.rfind("--counter=", 0) == 0)
+      counter = arg.substr(10);
+    else if (arg == "--stream")
+      stream = true;
+    else if (arg == "--all-sources")
+      allSources = true;
+    else if (arg.rfind("--trace=", 0) == 0)
+      tracePath = arg.substr(8);
+    else if (arg.rfind("--dump-trace=", 0) == 0)
+      dumpPath = arg.substr(13);
+    else if (arg == "--batch" && i + 1 < argc)
+      batch = argv[++i];
+    else if (arg.rfind("--threads=", 0) == 0 && std::atoi(arg.c_str() + 10) > 0)
+      threads = std::atoi(arg.c_str() + 10);
+    else
+    {
+      std::cerr << "Unknown argument: " << arg << std::endl;
+      return 1;
+    }
+  }
+
+  if (!counter.empty() && engine2 != PART2_ROW_SWEEP)
+  {
+    std::cerr << "--counter only works with the sweep engine" << std::endl;
+    return 1;
+  }
+  Part2Solver part2 = makePart2Solver(engine2, counter);
+  if (!part2)
+  {
+    std::cerr << "Unknown counter: " << counter << std::endl;
+    return 1;
+  }
 
-  // Parse the grid
-  while (std::getline(file, line))
+  if (stream)
   {
-    grid.push_back(line);
+    std::ios::sync_with_stdio(false);
+    if (counter == "u128")
+      return runStream<unsigned __int128>(std::cin, "");
+    if (counter == "big")
+      return runStream<BigCounter<4>>(std::cin, "");
+    if (counter == "mod")
+      return runStream<ModCounter<1000000007>>(std::cin, " (mod 1000000007)");
+    return runStream<unsigned long long>(std::cin, "");
   }
 
-  std::cout << "Part 1 - Total splits: " << solpart1(grid) << std::endl;
-  std::cout << "Part 2 - Total timelines: " << solpart2(grid) << std::endl;
+  std::string error;
+  if (!dumpPath.empty())
+    return dumpTrace(dumpPath);
+
+  if (!batch.empty())
+  {
+    std::vector<std::string> paths;
+    if (!listBatch(batch, paths, error))
+    {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+    runBatch(paths, threads, engine1, part2);
+    return 0;
+  }
+
+  Grid grid;
+  double loadSeconds = 0;
+  {
+    SolverPhaseTimer timer(loadSeconds);
+    if (!loadGrid("input/input.txt", grid, error))
+    {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+  }
+
+  if (allSources)
+  {
+    MultiSourceResult<> result = solveSources(grid);
+    std::cout << "Part 1 - Total splits: " << result.splits << std::endl;
+    for (size_t i = 0; i < result.sources.size(); i++)
+    {
+      std::cout << "Part 2 - Timelines from (" << result.sources[i].first << ", " << result.sources[i].second
+                << "): " << toString(result.timelines[i]) << std::endl;
+    }
+    std::cout << "Part 2 - Total timelines: " << toString(result.total) << std::endl;
+    return 0;
+  }
+
+  if (!tracePath.empty())
+  {
+    // only the BFS and DFS engines report events
+    TraceRecorder recorder;
+    if (!recorder.open(tracePath, grid.rows, grid.cols, error))
+    {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+    int splits = solpart1Observed(grid, recorder);
+    long long timelines = solpart2Observed(grid, recorder);
+    if (!recorder.close())
+    {
+      std::cerr << "Failed to write " << tracePath << std::endl;
+      return 1;
+    }
+    std::cout << "Part 1 - Total splits: " << splits << std::endl;
+    std::cout << "Part 2 - Total timelines: " << timelines << std::endl;
+    std::cout << "Recorded " << recorder.events() << " events to " << tracePath << std::endl;
+    return 0;
+  }
+
+  SolverStats stats1, stats2;
+  double solveSeconds1 = 0, solveSeconds2 = 0;
+  int splits;
+  std::string timelines;
+  {
+    resetSolverStats();
+    SolverPhaseTimer timer(solveSeconds1);
+    splits = solpart1(grid, engine1);
+  }
+  stats1 = solverStats();
+  {
+    resetSolverStats();
+    SolverPhaseTimer timer(solveSeconds2);
+    timelines = part2(grid);
+  }
+  stats2 = solverStats();
+
+  std::cout << "Part 1 - Total splits: " << splits << std::endl;
+  std::cout << "Part 2 - Total timelines: " << timelines << std::endl;
+
+#ifdef SOLVER_STATS
+  std::cerr << "{\"load_ms\": " << loadSeconds * 1e3 << ", \"part1\": ";
+  printStatsJson(std::cerr, stats1, solveSeconds1);
+  std::cerr << ", \"part2\": ";
+  printStatsJson(std::cerr, stats2, solveSeconds2);
+  std::cerr << "}" << std::endl;
+#endif
 
   return 0;
 }
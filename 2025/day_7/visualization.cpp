@@ -8,13 +8,17 @@
 #include <fstream>
 #include <iostream>
 #include <queue>
-#include <set>
 #include <map>
 #include <stack>
 #include <cmath>
 #include <thread>
-#include <mutex>
+#include <deque>
+#include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <csignal>
+#include <sys/wait.h>
+#include <limits>
 
 // Configuration
 const int WINDOW_WIDTH = 1200;
@@ -97,6 +101,221 @@ private:
   }
 };
 
+// Renders the sonification of a whole run offline into one 44.1 kHz WAV, no audio
+// device needed. The run is fitted to a fixed duration: event i of n starts in
+// time slot i * slots / n, and notes of the same tone within one slot merge, so the
+// mixing cost depends on the duration and not on the number of events.
+// Pitches are quantized to semitones so every note plays a precomputed table, on a
+// fixed pool of voices that steals the oldest one when all are busy.
+class OfflineMixer
+{
+public:
+  static const int SAMPLE_RATE = 44100;
+  static const int SLOT_SAMPLES = SAMPLE_RATE / 100; // 10 ms
+  static const int VOICES = 32;
+
+  OfflineMixer()
+  {
+    // same tones as SoundSystem, moves on a semitone scale from A2 to A5
+    for (int i = 0; i < MOVE_TONES; i++)
+      addTone(110 * std::pow(2.0, i / 12.0), 0.05, 0.2f);
+    addTone(880, 0.1, 0.4f);  // SPLIT_TONE
+    addTone(1760, 0.2, 0.6f); // MEMO_TONE
+  }
+
+  // Same interface as SoundSystem
+  void playMove(float pitch = 1.0f)
+  {
+    double freq = 440 * pitch * 0.5;
+    int semitone = (int)std::lround(12 * std::log2(freq / 110));
+    notes.push_back((unsigned char)std::min(std::max(semitone, 0), MOVE_TONES - 1));
+  }
+  void playSplit() { notes.push_back(SPLIT_TONE); }
+  void playMemo() { notes.push_back(MEMO_TONE); }
+
+  size_t events() const { return notes.size(); }
+
+  // Mix everything played so far into seconds of audio, plus the ring-out of the
+  // last notes, and write it as 16-bit mono PCM
+  bool writeWav(const std::string &path, double seconds, std::string &error)
+  {
+    size_t slots = std::max<size_t>(1, (size_t)(seconds * SAMPLE_RATE) / SLOT_SAMPLES);
+    int toneCount = tones.size();
+
+    // which tones start in which slot
+    std::vector<unsigned char> starts(slots * toneCount, 0);
+    for (size_t i = 0; i < notes.size(); i++)
+      starts[(unsigned long long)i * slots / notes.size() * toneCount + notes[i]] = 1;
+
+    size_t longest = 0;
+    for (const Tone &tone : tones)
+      longest = std::max(longest, tone.samples.size());
+    std::vector<float> mix(slots * SLOT_SAMPLES + longest, 0.0f);
+
+    Voice voices[VOICES];
+    for (size_t slot = 0, at = 0; at < mix.size(); slot++, at += SLOT_SAMPLES)
+    {
+      for (int t = 0; slot < slots && t < toneCount; t++)
+      {
+        if (starts[slot * toneCount + t])
+          allocate(voices) = {&tones[t], 0};
+      }
+
+      size_t block = std::min<size_t>(SLOT_SAMPLES, mix.size() - at);
+      for (Voice &voice : voices)
+      {
+        if (!voice.tone)
+          continue;
+        size_t n = std::min(block, voice.tone->samples.size() - voice.position);
+        mixInto(mix.data() + at, voice.tone->samples.data() + voice.position, voice.tone->volume, n);
+        voice.position += n;
+        if (voice.position == voice.tone->samples.size())
+          voice.tone = nullptr;
+      }
+    }
+
+    // scale down only if the voices add up past full scale
+    float peak = 1.0f;
+    for (float sample : mix)
+      peak = std::max(peak, std::fabs(sample));
+    std::vector<sf::Int16> pcm(mix.size());
+    for (size_t i = 0; i < mix.size(); i++)
+      pcm[i] = (sf::Int16)(mix[i] / peak * 32767);
+
+    return writePcm(path, pcm, error);
+  }
+
+private:
+  enum
+  {
+    MOVE_TONES = 37,
+    SPLIT_TONE = MOVE_TONES,
+    MEMO_TONE
+  };
+
+  struct Tone
+  {
+    std::vector<float> samples;
+    float volume;
+  };
+
+  struct Voice
+  {
+    const Tone *tone = nullptr;
+    size_t position = 0;
+  };
+
+  std::vector<Tone> tones;
+  std::vector<unsigned char> notes; // tone of every event, in order
+
+  // Same envelope as SoundSystem::generateTone, at full scale
+  void addTone(double freq, double duration, float volume)
+  {
+    Tone tone;
+    tone.volume = volume;
+    int sampleCount = SAMPLE_RATE * duration;
+    for (int i = 0; i < sampleCount; i++)
+    {
+      double t = (double)i / SAMPLE_RATE;
+      tone.samples.push_back((float)(std::exp(-10 * t / duration) * std::sin(2 * 3.14159 * freq * t)));
+    }
+    tones.push_back(std::move(tone));
+  }
+
+  // A free voice, or the one that has played the longest
+  static Voice &allocate(Voice *voices)
+  {
+    Voice *oldest = &voices[0];
+    for (int v = 0; v < VOICES; v++)
+    {
+      if (!voices[v].tone)
+        return voices[v];
+      if (voices[v].position > oldest->position)
+        oldest = &voices[v];
+    }
+    return *oldest;
+  }
+
+  // Fixed 8-wide chunks, which the compiler turns into vector adds even at -O2
+  static void mixInto(float *__restrict out, const float *__restrict in, float gain, size_t n)
+  {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+      for (int k = 0; k < 8; k++)
+        out[i + k] += gain * in[i + k];
+    }
+    for (; i < n; i++)
+      out[i] += gain * in[i];
+  }
+
+  static bool writePcm(const std::string &path, const std::vector<sf::Int16> &pcm, std::string &error)
+  {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+      error = "Failed to create " + path;
+      return false;
+    }
+
+    auto u32 = [&](unsigned value)
+    {
+      char bytes[4] = {(char)value, (char)(value >> 8), (char)(value >> 16), (char)(value >> 24)};
+      file.write(bytes, 4);
+    };
+    auto u16 = [&](unsigned value)
+    {
+      char bytes[2] = {(char)value, (char)(value >> 8)};
+      file.write(bytes, 2);
+    };
+    unsigned dataBytes = pcm.size() * 2;
+    file.write("RIFF", 4);
+    u32(36 + dataBytes);
+    file.write("WAVEfmt ", 8);
+    u32(16);
+    u16(1); // PCM
+    u16(1); // mono
+    u32(SAMPLE_RATE);
+    u32(SAMPLE_RATE * 2);
+    u16(2);
+    u16(16);
+    file.write("data", 4);
+    u32(dataBytes);
+    for (sf::Int16 sample : pcm)
+      u16((unsigned short)sample);
+
+    if (!file)
+    {
+      error = "Failed to write " + path;
+      return false;
+    }
+    return true;
+  }
+};
+
+// The sound a solver step makes, for SoundSystem and OfflineMixer alike
+template <typename Sound>
+void playEvent(Sound &sound, const Grid &grid, const TraceEvent &event)
+{
+  if (event.kind == TRACE_BEAM_STEP)
+  {
+    if (grid.at(event.r, event.c) == '^')
+      sound.playSplit();
+    else
+    {
+      // Pitch based on column to give stereo-like effect or just variation
+      sound.playMove(0.8f + (float)event.c / grid.cols * 0.4f);
+    }
+  }
+  else if (event.kind == TRACE_DFS_VISIT)
+  {
+    // Sound based on column
+    sound.playMove(1.0f + (float)event.c / grid.cols);
+  }
+  else if (event.kind == TRACE_DFS_MEMO_HIT)
+    sound.playMemo();
+}
+
 enum Mode
 {
   MODE_BFS,
@@ -107,23 +326,20 @@ enum Mode
 class Visualizer
 {
 public:
-  Visualizer(const std::vector<std::string> &grid) : grid(grid)
+  // eventsPerFrame = 0 runs in real time: the solver is paced with sleeps and plays
+  // sound, and each frame shows whatever arrived since the last one.
+  // Otherwise every frame shows exactly eventsPerFrame more events (fewer only on
+  // the last one) and the solver runs flat out with no sleeps and no audio device.
+  Visualizer(const Grid &grid, size_t eventsPerFrame = 0) : grid(grid), eventsPerFrame(eventsPerFrame)
   {
-    rows = grid.size();
-    cols = rows > 0 ? grid[0].size() : 0;
+    rows = grid.rows;
+    cols = grid.cols;
 
-    // Find start
-    for (int r = 0; r < rows; r++)
-    {
-      for (int c = 0; c < cols; c++)
-      {
-        if (grid[r][c] == 'S')
-        {
-          startRow = r;
-          startCol = c;
-        }
-      }
-    }
+    if (eventsPerFrame == 0)
+      soundSystem.reset(new SoundSystem());
+
+    // Find emitters
+    sources = findSources(grid);
 
     // Start the solver thread
     solverThread = std::thread(&Visualizer::runSolver, this);
@@ -131,45 +347,27 @@ public:
 
   ~Visualizer()
   {
+    // the solver stops publishing, sleeping and playing sound, and runs out quickly
+    stopRequested.store(true, std::memory_order_release);
     if (solverThread.joinable())
-    {
-      // In a real app we should signal thread to stop
-      // For now we just detach or let it finish if it's fast
-      // But since it has infinite loops/sleeps, we should detach
-      solverThread.detach();
-    }
+      solverThread.join();
   }
 
-  void draw(sf::RenderWindow &window)
-  {
-    std::lock_guard<std::mutex> lock(stateMutex);
+  // True once every event of both parts has been drawn
+  bool finished() const { return mode == MODE_DONE; }
 
-    // Draw static elements (splitters as ornaments)
-    for (int r = 0; r < rows; r++)
-    {
-      for (int c = 0; c < cols; c++)
-      {
-        float x = OFFSET_X + c * CELL_SIZE;
-        float y = OFFSET_Y + r * CELL_SIZE;
+  // Per frame this only draws the events that arrived since the last frame, the
+  // splitters and everything drawn before live in two cached layers
+  void draw(sf::RenderTarget &target)
+  {
+    drainEvents();
 
-        if (grid[r][c] == '^')
-        {
-          sf::CircleShape ornament(CELL_SIZE / 2.5f);
-          ornament.setPosition(x, y);
-          ornament.setFillColor(COLOR_SPLITTER);
-          window.draw(ornament);
-        }
-      }
-    }
+    if (!layersReady)
+      bakeLayers(target.getSize());
+    flushTrail();
 
-    // Draw visited paths (Tree branches)
-    // Use lines instead of points for connections
-    sf::VertexArray lines(sf::Lines);
-    for (auto &line : treeLines)
-    {
-      lines.append(line);
-    }
-    window.draw(lines);
+    target.draw(sf::Sprite(staticLayer.getTexture()));
+    target.draw(sf::Sprite(trailLayer.getTexture()));
 
     // Draw active beams/probes
     if (mode == MODE_BFS)
@@ -178,7 +376,7 @@ public:
       sf::CircleShape light(CELL_SIZE / 1.5f);
       light.setPosition(OFFSET_X + currentBeam.col * CELL_SIZE, OFFSET_Y + currentBeam.row * CELL_SIZE);
       light.setFillColor(COLOR_BEAM);
-      window.draw(light);
+      target.draw(light);
     }
     else if (mode == MODE_DFS)
     {
@@ -186,160 +384,499 @@ public:
       sf::CircleShape probe(CELL_SIZE / 1.5f);
       probe.setPosition(OFFSET_X + dfsProbe.col * CELL_SIZE, OFFSET_Y + dfsProbe.row * CELL_SIZE);
       probe.setFillColor(sf::Color::Yellow);
-      window.draw(probe);
-
-      // Draw Memo Hits
-      for (auto const &p : memoHits)
-      {
-        sf::CircleShape dot(CELL_SIZE / 2.0f);
-        dot.setPosition(OFFSET_X + p.second * CELL_SIZE, OFFSET_Y + p.first * CELL_SIZE);
-        dot.setFillColor(COLOR_MEMO);
-        window.draw(dot);
-      }
+      target.draw(probe);
     }
   }
 
 private:
-  std::vector<std::string> grid;
+  Grid grid;
   int rows, cols;
-  int startRow, startCol;
-
-  // Shared State
-  std::mutex stateMutex;
+  std::vector<std::pair<int, int>> sources;
+  size_t eventsPerFrame;
+
+  // Solver -> render handoff
+  // The solver thread publishes every step into a lock-free ring and the render
+  // thread drains it once per frame into its own state below, so neither ever
+  // waits for the other. If the ring is full the solver parks events in overflow
+  // (solver thread only) and retries on the next publish. Headless runs wait for
+  // room instead, the renderer is consuming as fast as it can anyway.
+  SpscRing<TraceEvent> events{1 << 16};
+  std::deque<TraceEvent> overflow;
+  std::atomic<bool> solverDone{false};
+  std::atomic<bool> stopRequested{false}; // set when the Visualizer is destroyed early
+
+  // Render state, render thread only
   Mode mode = MODE_BFS;
 
+  // Cached layers, sized to the target on the first frame
+  // staticLayer: splitters and emitters, drawn once
+  // trailLayer: tree branches and memo hits, new ones are drawn on top each frame
+  sf::RenderTexture staticLayer;
+  sf::RenderTexture trailLayer;
+  bool layersReady = false;
+  bool clearTrail = false;
+
   // BFS State
   Beam currentBeam = {0, 0, 0, 0};
-  std::vector<sf::Vertex> treeLines;
+  std::vector<sf::Vertex> newLines; // since the last frame
 
   // DFS State
   Beam dfsProbe = {0, 0, 0, 0};
-  std::vector<std::pair<int, int>> memoHits;
+  std::vector<sf::Vertex> newDots; // memo hits since the last frame, as triangles
 
   std::thread solverThread;
-  SoundSystem soundSystem;
+  std::unique_ptr<SoundSystem> soundSystem; // real time only
 
-  void runSolver()
+  bool stopping() const { return stopRequested.load(std::memory_order_acquire); }
+
+  // sleep on the solver thread, cut short by a stop request
+  void pause(std::chrono::milliseconds duration)
   {
-    // Run Part 1 (BFS)
+    auto until = std::chrono::steady_clock::now() + duration;
+    while (!stopping() && std::chrono::steady_clock::now() < until)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  void publish(const TraceEvent &event)
+  {
+    if (eventsPerFrame > 0)
     {
-      std::lock_guard<std::mutex> lock(stateMutex);
-      mode = MODE_BFS;
+      while (!events.push(event))
+      {
+        if (stopping())
+          return;
+        std::this_thread::yield();
+      }
+      return;
     }
+    while (!overflow.empty() && events.push(overflow.front()))
+      overflow.pop_front();
+    if (!overflow.empty() || !events.push(event))
+      overflow.push_back(event);
+  }
 
-    int bfsStep = 0;
-    auto bfsCallback = [this, &bfsStep](int r, int c, int from_r, int from_c, const std::set<std::pair<int, int>> &visitedSplitters)
+  void drainEvents()
+  {
+    if (eventsPerFrame > 0)
     {
+      // wait for a full frame's worth unless the solver is done
+      TraceEvent event;
+      for (size_t n = 0; n < eventsPerFrame;)
       {
-        std::lock_guard<std::mutex> lock(stateMutex);
-        currentBeam = {r, c, from_r, from_c};
+        bool done = solverDone.load(std::memory_order_acquire);
+        if (events.pop(event))
+        {
+          apply(event);
+          n++;
+        }
+        else if (done)
+        {
+          mode = MODE_DONE;
+          break;
+        }
+        else
+          std::this_thread::yield();
+      }
+      // a frame that took the very last events is the last frame
+      if (mode != MODE_DONE && solverDone.load(std::memory_order_acquire) && events.empty())
+        mode = MODE_DONE;
+      return;
+    }
 
-        // Add line from previous to current
-        float x1 = OFFSET_X + from_c * CELL_SIZE + CELL_SIZE / 2;
-        float y1 = OFFSET_Y + from_r * CELL_SIZE + CELL_SIZE / 2;
-        float x2 = OFFSET_X + c * CELL_SIZE + CELL_SIZE / 2;
-        float y2 = OFFSET_Y + r * CELL_SIZE + CELL_SIZE / 2;
+    // read the flag first, everything published before it was set is in the ring
+    bool done = solverDone.load(std::memory_order_acquire);
+    TraceEvent event;
+    while (events.pop(event))
+      apply(event);
+    if (done)
+      mode = MODE_DONE;
+  }
 
-        treeLines.push_back(sf::Vertex(sf::Vector2f(x1, y1), COLOR_TREE));
-        treeLines.push_back(sf::Vertex(sf::Vector2f(x2, y2), COLOR_TREE));
-      }
+  void apply(const TraceEvent &event)
+  {
+    if (event.kind == TRACE_BEAM_STEP)
+    {
+      currentBeam = {event.r, event.c, event.from_r, event.from_c};
+      addLine(event);
+      return;
+    }
 
-      // Sound
-      if (grid[r][c] == '^')
+    if (mode == MODE_BFS)
+    {
+      // first Part 2 event, start over with an empty tree
+      mode = MODE_DFS;
+      clearTrail = true;
+      newLines.clear();
+    }
+    dfsProbe = {event.r, event.c, event.from_r, event.from_c};
+    if (event.kind == TRACE_DFS_VISIT)
+      addLine(event);
+    else if (event.kind == TRACE_DFS_MEMO_HIT)
+      addCircle(newDots, OFFSET_X + event.c * CELL_SIZE, OFFSET_Y + event.r * CELL_SIZE, CELL_SIZE / 2.0f, COLOR_MEMO);
+  }
+
+  // Same footprint as an sf::CircleShape of that radius at (x, y), as a triangle fan
+  // unrolled into plain triangles so any number of them batch into one draw call
+  static void addCircle(std::vector<sf::Vertex> &triangles, float x, float y, float radius, sf::Color color)
+  {
+    const int segments = 8;
+    sf::Vector2f center(x + radius, y + radius);
+    for (int i = 0; i < segments; i++)
+    {
+      float a1 = 2 * 3.14159f * i / segments;
+      float a2 = 2 * 3.14159f * (i + 1) / segments;
+      triangles.push_back(sf::Vertex(center, color));
+      triangles.push_back(sf::Vertex(sf::Vector2f(center.x + radius * std::cos(a1), center.y + radius * std::sin(a1)), color));
+      triangles.push_back(sf::Vertex(sf::Vector2f(center.x + radius * std::cos(a2), center.y + radius * std::sin(a2)), color));
+    }
+  }
+
+  // Draw the splitters and emitters once. Only the cells that fall inside the
+  // target are drawn, in batches so the vertex buffer stays small on huge grids.
+  void bakeLayers(sf::Vector2u size)
+  {
+    staticLayer.create(size.x, size.y);
+    trailLayer.create(size.x, size.y);
+    staticLayer.clear(COLOR_BG);
+    trailLayer.clear(sf::Color::Transparent);
+
+    int visibleRows = std::min(rows, (int)((size.y - OFFSET_Y) / CELL_SIZE) + 1);
+    int visibleCols = std::min(cols, (int)((size.x - OFFSET_X) / CELL_SIZE) + 1);
+    std::vector<sf::Vertex> batch;
+    for (int r = 0; r < visibleRows; r++)
+    {
+      const char *line = grid.row(r);
+      for (int c = 0; c < visibleCols; c++)
       {
-        soundSystem.playSplit();
+        if (line[c] == '^')
+          addCircle(batch, OFFSET_X + c * CELL_SIZE, OFFSET_Y + r * CELL_SIZE, CELL_SIZE / 2.5f, COLOR_SPLITTER);
       }
-      else
+      if (batch.size() >= (1 << 16))
       {
-        // Pitch based on column to give stereo-like effect or just variation
-        float pitch = 0.8f + (float)c / cols * 0.4f;
-        soundSystem.playMove(pitch);
+        staticLayer.draw(batch.data(), batch.size(), sf::Triangles);
+        batch.clear();
       }
+    }
+    for (auto const &source : sources)
+      addCircle(batch, OFFSET_X + source.second * CELL_SIZE, OFFSET_Y + source.first * CELL_SIZE, CELL_SIZE / 1.5f, COLOR_BEAM);
+    staticLayer.draw(batch.data(), batch.size(), sf::Triangles);
+    staticLayer.display();
+    trailLayer.display();
+    layersReady = true;
+  }
+
+  // Draw what arrived since the last frame onto the trail layer
+  void flushTrail()
+  {
+    if (!clearTrail && newLines.empty() && newDots.empty())
+      return;
+    if (clearTrail)
+    {
+      trailLayer.clear(sf::Color::Transparent);
+      clearTrail = false;
+    }
+    trailLayer.draw(newLines.data(), newLines.size(), sf::Lines);
+    trailLayer.draw(newDots.data(), newDots.size(), sf::Triangles);
+    trailLayer.display();
+    newLines.clear();
+    newDots.clear();
+  }
+
+  // Line from the previous cell to the current one
+  void addLine(const TraceEvent &event)
+  {
+    float x1 = OFFSET_X + event.from_c * CELL_SIZE + CELL_SIZE / 2;
+    float y1 = OFFSET_Y + event.from_r * CELL_SIZE + CELL_SIZE / 2;
+    float x2 = OFFSET_X + event.c * CELL_SIZE + CELL_SIZE / 2;
+    float y2 = OFFSET_Y + event.r * CELL_SIZE + CELL_SIZE / 2;
+
+    newLines.push_back(sf::Vertex(sf::Vector2f(x1, y1), COLOR_TREE));
+    newLines.push_back(sf::Vertex(sf::Vector2f(x2, y2), COLOR_TREE));
+  }
+
+  void runSolver()
+  {
+    // Run Part 1 (BFS)
+    int bfsStep = 0;
+    auto bfsCallback = [this, &bfsStep](int r, int c, int from_r, int from_c, const SplitterView &)
+    {
+      if (stopping())
+        return;
+      TraceEvent event = {TRACE_BEAM_STEP, r, c, from_r, from_c, 0};
+      publish(event);
+
+      if (!soundSystem)
+        return;
+      playEvent(*soundSystem, grid, event);
 
       // Speed up: only sleep every 10 steps
       if (bfsStep++ % 10 == 0)
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        pause(std::chrono::milliseconds(1));
     };
 
-    solpart1(grid, bfsCallback);
+    solpart1Observed(grid, bfsCallback);
 
-    // Transition
-    std::this_thread::sleep_for(std::chrono::seconds(2));
-
-    {
-      std::lock_guard<std::mutex> lock(stateMutex);
-      mode = MODE_DFS;
-      treeLines.clear(); // Clear for Part 2
-    }
+    // Transition, the render thread switches to Part 2 on its first event
+    if (stopping())
+      return;
+    if (soundSystem)
+      pause(std::chrono::seconds(2));
 
     // Run Part 2 (DFS)
     int dfsStep = 0;
     auto dfsCallback = [this, &dfsStep](int r, int c, int from_r, int from_c, DFSAction action, long long val)
     {
-      {
-        std::lock_guard<std::mutex> lock(stateMutex);
-        dfsProbe = {r, c, from_r, from_c};
+      if (stopping())
+        return;
+      TraceEvent event = {(TraceEventKind)(TRACE_DFS_VISIT + action), r, c, from_r, from_c, val};
+      publish(event);
 
-        if (action == DFS_VISIT)
-        {
-          // Add line for DFS path
-          float x1 = OFFSET_X + from_c * CELL_SIZE + CELL_SIZE / 2;
-          float y1 = OFFSET_Y + from_r * CELL_SIZE + CELL_SIZE / 2;
-          float x2 = OFFSET_X + c * CELL_SIZE + CELL_SIZE / 2;
-          float y2 = OFFSET_Y + r * CELL_SIZE + CELL_SIZE / 2;
-
-          treeLines.push_back(sf::Vertex(sf::Vector2f(x1, y1), COLOR_TREE));
-          treeLines.push_back(sf::Vertex(sf::Vector2f(x2, y2), COLOR_TREE));
-        }
-        else if (action == DFS_MEMO_HIT)
-        {
-          memoHits.push_back({r, c});
-        }
-      }
+      if (!soundSystem)
+        return;
+      playEvent(*soundSystem, grid, event);
 
       if (action == DFS_VISIT)
       {
-        // Sound based on column
-        float pitch = 1.0f + (float)c / cols;
-        soundSystem.playMove(pitch);
-
         if (dfsStep++ % 50 == 0) // Much faster
-          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          pause(std::chrono::milliseconds(1));
       }
       else if (action == DFS_MEMO_HIT)
       {
-        soundSystem.playMemo();
-        std::this_thread::sleep_for(std::chrono::milliseconds(50)); // Pause on hit
+        pause(std::chrono::milliseconds(50)); // Pause on hit
       }
     };
 
-    solpart2(grid, dfsCallback);
+    solpart2Observed(grid, dfsCallback);
 
+    while (!overflow.empty() && !stopping())
     {
-      std::lock_guard<std::mutex> lock(stateMutex);
-      mode = MODE_DONE;
+      if (events.push(overflow.front()))
+        overflow.pop_front();
+      else
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
+    solverDone.store(true, std::memory_order_release);
   }
 };
 
-int main()
+// Headless export, frames go either to numbered image files in a directory or
+// as raw RGBA to the stdin of an encoder command
+class FrameSink
 {
-  // Load Grid
-  std::vector<std::string> grid;
-  std::ifstream file("2025/day_7/input/input.txt");
-  if (!file.is_open())
+public:
+  ~FrameSink()
   {
-    file.open("input/input.txt");
+    if (pipe)
+      pclose(pipe);
   }
-  if (!file.is_open())
+
+  bool openDirectory(const std::string &dir, const std::string &format, std::string &error)
+  {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec)
+    {
+      error = "Failed to create " + dir;
+      return false;
+    }
+    directory = dir;
+    extension = format;
+    return true;
+  }
+
+  bool openPipe(const std::string &command, std::string &error)
   {
-    std::cerr << "Failed to open input file" << std::endl;
+    // a dead encoder should fail the write, not kill us with SIGPIPE
+    std::signal(SIGPIPE, SIG_IGN);
+    pipe = popen(command.c_str(), "w");
+    if (!pipe)
+    {
+      error = "Failed to run " + command;
+      return false;
+    }
+    return true;
+  }
+
+  bool write(const sf::Image &image, std::string &error)
+  {
+    sf::Vector2u size = image.getSize();
+    const sf::Uint8 *pixels = image.getPixelsPtr();
+    size_t bytes = (size_t)size.x * size.y * 4;
+    if (pipe)
+    {
+      if (std::fwrite(pixels, 1, bytes, pipe) != bytes)
+      {
+        error = "Encoder stopped reading";
+        return false;
+      }
+      return true;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "frame_%06d.", frame++);
+    std::string path = directory + "/" + name + extension;
+    if (extension == "png")
+    {
+      if (!image.saveToFile(path))
+      {
+        error = "Failed to write " + path;
+        return false;
+      }
+      return true;
+    }
+
+    // binary PPM, RGBA -> RGB
+    std::vector<sf::Uint8> rgb((size_t)size.x * size.y * 3);
+    for (size_t i = 0, j = 0; i < bytes; i += 4, j += 3)
+    {
+      rgb[j] = pixels[i];
+      rgb[j + 1] = pixels[i + 1];
+      rgb[j + 2] = pixels[i + 2];
+    }
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    bool ok = file && std::fprintf(file, "P6\n%u %u\n255\n", size.x, size.y) > 0 &&
+              std::fwrite(rgb.data(), 1, rgb.size(), file) == rgb.size();
+    if (file && std::fclose(file) != 0)
+      ok = false;
+    if (!ok)
+      error = "Failed to write " + path;
+    return ok;
+  }
+
+private:
+  std::string directory;
+  std::string extension;
+  std::FILE *pipe = nullptr;
+  int frame = 0;
+};
+
+// sf::RenderTexture still needs an OpenGL context. On Linux SFML makes it through
+// GLX and calls abort() when there is no X display, so try once in a child process
+// and let a box without one fail with an error instead.
+bool canCreateGlContext()
+{
+#if defined(__unix__) && !defined(__APPLE__)
+  std::fflush(nullptr);
+  pid_t pid = fork();
+  if (pid < 0)
+    return true; // can't tell, let SFML try
+  if (pid == 0)
+  {
+    sf::Context context;
+    _exit(context.setActive(true) ? 0 : 1);
+  }
+  int status = 0;
+  if (waitpid(pid, &status, 0) != pid)
+    return true;
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#else
+  return true;
+#endif
+}
+
+int runHeadless(const Grid &grid, FrameSink &sink, size_t eventsPerFrame, unsigned width, unsigned height)
+{
+  sf::RenderTexture target;
+  if (!target.create(width, height))
+  {
+    std::cerr << "Failed to create a " << width << "x" << height << " render texture" << std::endl;
     return 1;
   }
-  std::string line;
-  while (std::getline(file, line))
+
+  Visualizer viz(grid, eventsPerFrame);
+  std::string error;
+  int frames = 0;
+  while (!viz.finished())
+  {
+    target.clear(COLOR_BG);
+    viz.draw(target);
+    target.display();
+    if (!sink.write(target.getTexture().copyToImage(), error))
+    {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+    frames++;
+  }
+  std::cout << "Wrote " << frames << " frames" << std::endl;
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  // Headless: --frames=dir [--format=ppm|png] or --pipe="encoder command",
+  // --events-per-frame=N events drawn per frame, --size=WxH of the frames
+  // Frames still render through OpenGL, so on Linux without a display run it
+  // under xvfb-run (e.g. xvfb-run ./visualization --frames=out) or use an EGL/DRM SFML build
+  // Offline audio: --wav=path [--wav-seconds=S] renders the sound of both parts
+  std::string framesDir, format = "ppm", pipeCommand, wavPath;
+  double wavSeconds = 30;
+  size_t eventsPerFrame = 500;
+  unsigned width = WINDOW_WIDTH, height = WINDOW_HEIGHT;
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg.rfind("--frames=", 0) == 0)
+      framesDir = arg.substr(9);
+    else if (arg == "--format=ppm" || arg == "--format=png")
+      format = arg.substr(9);
+    else if (arg.rfind("--wav=", 0) == 0)
+      wavPath = arg.substr(6);
+    else if (arg.rfind("--wav-seconds=", 0) == 0 && std::atof(arg.c_str() + 14) > 0)
+      wavSeconds = std::atof(arg.c_str() + 14);
+    else if (arg.rfind("--pipe=", 0) == 0)
+      pipeCommand = arg.substr(7);
+    else if (arg.rfind("--events-per-frame=", 0) == 0 && std::atol(arg.c_str() + 19) > 0)
+      eventsPerFrame = std::atol(arg.c_str() + 19);
+    else if (arg.rfind("--size=", 0) == 0 && sscanf(arg.c_str() + 7, "%ux%u", &width, &height) == 2 && width > 0 && height > 0)
+      ;
+    else
+    {
+      std::cerr << "Unknown argument: " << arg << std::endl;
+      return 1;
+    }
+  }
+
+  // Load Grid
+  Grid grid;
+  std::string error;
+  if (!loadGrid("2025/day_7/input/input.txt", grid, error) && !loadGrid("input/input.txt", grid, error))
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+
+  if (!wavPath.empty())
+  {
+    OfflineMixer mixer;
+    solpart1Observed(grid, [&](int r, int c, int from_r, int from_c, const SplitterView &)
+                     { playEvent(mixer, grid, {TRACE_BEAM_STEP, r, c, from_r, from_c, 0}); });
+    solpart2Observed(grid, [&](int r, int c, int from_r, int from_c, DFSAction action, long long val)
+                     { playEvent(mixer, grid, {(TraceEventKind)(TRACE_DFS_VISIT + action), r, c, from_r, from_c, val}); });
+    if (!mixer.writeWav(wavPath, wavSeconds, error))
+    {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+    std::cout << "Mixed " << mixer.events() << " events into " << wavPath << std::endl;
+    return 0;
+  }
+
+  if (!framesDir.empty() || !pipeCommand.empty())
   {
-    grid.push_back(line);
+    if (!canCreateGlContext())
+    {
+      std::cerr << "Headless export needs an OpenGL context: run it under xvfb-run, or build SFML with EGL/DRM" << std::endl;
+      return 1;
+    }
+    FrameSink sink;
+    bool opened = pipeCommand.empty() ? sink.openDirectory(framesDir, format, error) : sink.openPipe(pipeCommand, error);
+    if (!opened)
+    {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+    return runHeadless(grid, sink, eventsPerFrame, width, height);
   }
 
   sf::RenderWindow window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "AOC 2025 Day 7 - Christmas Tree Viz");
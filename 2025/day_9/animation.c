@@ -2,6 +2,8 @@
 // compile: gcc -std=c11 -O2 -o animation_sdl animation.c -lSDL2 -lm
 // install sdl2: sudo apt install libsdl2-dev
 
+#define ANIMATION_MODE
+#include "result.c"
 #include <SDL2/SDL.h>
 #include <stdio.h>
 #include <string.h>
@@ -9,11 +11,6 @@
 #include <math.h>
 #include <stdbool.h>
 
-typedef struct
-{
-  int x, y;
-} Point;
-
 typedef struct
 {
   int minx, miny, maxx, maxy;
@@ -21,10 +18,11 @@ typedef struct
   int i, j;
 } Rectangle;
 
-Point *pts = NULL;
-size_t n = 0;
+Polygon poly;
+PolygonIndex poly_index;
+int indexed; // 0 if the polygon has diagonal edges or the index didn't fit
 
-// bounds
+// view bounds
 int min_x, max_x, min_y, max_y;
 
 // window
@@ -33,87 +31,35 @@ int min_x, max_x, min_y, max_y;
 SDL_Window *window = NULL;
 SDL_Renderer *renderer = NULL;
 
-char *readFile()
-{
-  FILE *file = fopen("input/input.txt", "r");
-  static char content[100000];
-  char line[1000];
-
-  if (file)
-  {
-    content[0] = '\0';
-    while (fgets(line, sizeof(line), file))
-    {
-      strcat(content, line);
-    }
-    fclose(file);
-    return content;
-  }
-  return "";
-}
-
-void parseInput(char *input)
+// load the polygon and frame it with some padding
+int loadInput()
 {
-  if (input == NULL || input[0] == '\0')
-    return;
-
-  size_t len = strlen(input);
-  char *buf = malloc(len + 1);
-  if (!buf)
-    return;
-  memcpy(buf, input, len + 1);
-
-  size_t cap = 512;
-  pts = malloc(cap * sizeof(Point));
-  if (!pts)
-  {
-    free(buf);
-    return;
-  }
-
-  char *line = strtok(buf, "\n");
-  while (line)
-  {
-    int x, y;
-    if (sscanf(line, "%d,%d", &x, &y) == 2)
-    {
-      if (n >= cap)
-      {
-        cap *= 2;
-        Point *tmp = realloc(pts, cap * sizeof(Point));
-        if (!tmp)
-          break;
-        pts = tmp;
-      }
-      pts[n].x = x;
-      pts[n].y = y;
-      n++;
-    }
-    line = strtok(NULL, "\n");
-  }
-  free(buf);
-
-  // find bounds with padding
-  min_x = pts[0].x;
-  max_x = pts[0].x;
-  min_y = pts[0].y;
-  max_y = pts[0].y;
-  for (size_t i = 1; i < n; i++)
-  {
-    if (pts[i].x < min_x)
-      min_x = pts[i].x;
-    if (pts[i].x > max_x)
-      max_x = pts[i].x;
-    if (pts[i].y < min_y)
-      min_y = pts[i].y;
-    if (pts[i].y > max_y)
-      max_y = pts[i].y;
-  }
+  PointArray points = {0};
+  if (!loadPoints("input/input.txt", &points))
+    return 0;
+  int built = buildPolygon(points.data, points.count, &poly);
+  free(points.data);
+  if (!built || poly.n == 0)
+    return built;
+  indexed = buildPolygonIndex(&poly, &poly_index);
+
+  min_x = poly.min_x;
+  max_x = poly.max_x;
+  min_y = poly.min_y;
+  max_y = poly.max_y;
   int pad = (max_x - min_x) / 20;
   min_x -= pad;
   max_x += pad;
   min_y -= pad;
   max_y += pad;
+  return 1;
+}
+
+int validRectangle(int minx, int miny, int maxx, int maxy)
+{
+  if (indexed)
+    return isValidRectangleIndexed(&poly_index, minx, miny, maxx, maxy);
+  return isValidRectangle(&poly, minx, miny, maxx, maxy);
 }
 
 // convert world coords to screen coords
@@ -204,71 +150,26 @@ void drawPolygon(size_t edgeCount, bool showVertices)
 {
   // draw edges
   setColor(50, 205, 50, 255); // green
-  for (size_t i = 0; i < edgeCount && i < n; i++)
+  for (size_t i = 0; i < edgeCount && i < poly.n; i++)
   {
-    size_t next = (i + 1) % n;
-    drawThickLine(pts[i].x, pts[i].y, pts[next].x, pts[next].y, 2);
+    size_t next = (i + 1) % poly.n;
+    drawThickLine(poly.x[i], poly.y[i], poly.x[next], poly.y[next], 2);
   }
 
   // draw vertices
   if (showVertices)
   {
     setColor(255, 80, 80, 255); // red
-    for (size_t i = 0; i <= edgeCount && i < n; i++)
+    for (size_t i = 0; i <= edgeCount && i < poly.n; i++)
     {
-      fillCircle(pts[i].x, pts[i].y, 4);
+      fillCircle(poly.x[i], poly.y[i], 4);
     }
   }
 }
 
 void drawPolygonFull()
 {
-  drawPolygon(n, true);
-}
-
-int isValidPart2(int minx, int miny, int maxx, int maxy)
-{
-  for (size_t k = 0; k < n; k++)
-  {
-    size_t next = (k + 1) % n;
-    int ex1 = pts[k].x, ey1 = pts[k].y;
-    int ex2 = pts[next].x, ey2 = pts[next].y;
-
-    if (ex1 == ex2)
-    {
-      int edge_miny = (ey1 < ey2) ? ey1 : ey2;
-      int edge_maxy = (ey1 < ey2) ? ey2 : ey1;
-      if (ex1 > minx && ex1 < maxx)
-        if (edge_miny < maxy && edge_maxy > miny)
-          return 0;
-    }
-    else if (ey1 == ey2)
-    {
-      int edge_minx = (ex1 < ex2) ? ex1 : ex2;
-      int edge_maxx = (ex1 < ex2) ? ex2 : ex1;
-      if (ey1 > miny && ey1 < maxy)
-        if (edge_minx < maxx && edge_maxx > minx)
-          return 0;
-    }
-  }
-
-  int cx = (minx + maxx) / 2;
-  int cy = (miny + maxy) / 2;
-  int crossings = 0;
-  for (size_t k = 0; k < n; k++)
-  {
-    size_t next = (k + 1) % n;
-    int px1 = pts[k].x, py1 = pts[k].y;
-    int px2 = pts[next].x, py2 = pts[next].y;
-    if ((py1 <= cy && cy < py2) || (py2 <= cy && cy < py1))
-    {
-      double t = (double)(cy - py1) / (py2 - py1);
-      double x_intersect = px1 + t * (px2 - px1);
-      if (cx < x_intersect)
-        crossings++;
-    }
-  }
-  return (crossings % 2) == 1;
+  drawPolygon(poly.n, true);
 }
 
 bool handleEvents()
@@ -294,16 +195,19 @@ int main(int argc, char *argv[])
   (void)argc;
   (void)argv;
 
-  char *input = readFile();
-  parseInput(input);
+  if (!loadInput())
+  {
+    printf("failed to read input/input.txt\n");
+    return 1;
+  }
 
-  if (n < 2)
+  if (poly.n < 2)
   {
     printf("not enough points\n");
     return 1;
   }
 
-  printf("loaded %zu points\n", n);
+  printf("loaded %zu points\n", poly.n);
 
   // init sdl
   if (SDL_Init(SDL_INIT_VIDEO) < 0)
@@ -332,7 +236,7 @@ int main(int argc, char *argv[])
 
   // phase 1: draw polygon edges one by one
   printf("phase 1: drawing polygon...\n");
-  for (size_t i = 0; i <= n; i++)
+  for (size_t i = 0; i <= poly.n; i++)
   {
     if (!handleEvents())
       goto cleanup;
@@ -351,21 +255,21 @@ int main(int argc, char *argv[])
   // phase 2: search for part 1
   printf("phase 2: searching part 1...\n");
   Rectangle best1 = {0, 0, 0, 0, 0, -1, -1};
-  int step = (int)(n / 80) + 1;
+  int step = (int)(poly.n / 80) + 1;
 
-  for (size_t i = 0; i < n; i += step)
+  for (size_t i = 0; i < poly.n; i += step)
   {
-    for (size_t j = i + 1; j < n; j += step)
+    for (size_t j = i + 1; j < poly.n; j += step)
     {
       if (!handleEvents())
         goto cleanup;
 
-      long long dx = llabs((long long)pts[i].x - (long long)pts[j].x);
-      long long dy = llabs((long long)pts[i].y - (long long)pts[j].y);
+      long long dx = llabs((long long)poly.x[i] - (long long)poly.x[j]);
+      long long dy = llabs((long long)poly.y[i] - (long long)poly.y[j]);
       long long area = (dx + 1) * (dy + 1);
 
-      int x1 = pts[i].x, y1 = pts[i].y;
-      int x2 = pts[j].x, y2 = pts[j].y;
+      int x1 = poly.x[i], y1 = poly.y[i];
+      int x2 = poly.x[j], y2 = poly.y[j];
       int minx = (x1 < x2) ? x1 : x2;
       int maxx = (x1 < x2) ? x2 : x1;
       int miny = (y1 < y2) ? y1 : y2;
@@ -378,9 +282,9 @@ int main(int argc, char *argv[])
       if (best1.i >= 0)
       {
         setColor(66, 135, 245, 60);
-        fillRect(pts[best1.i].x, pts[best1.i].y, pts[best1.j].x, pts[best1.j].y);
+        fillRect(poly.x[best1.i], poly.y[best1.i], poly.x[best1.j], poly.y[best1.j]);
         setColor(66, 135, 245, 200);
-        drawRect(pts[best1.i].x, pts[best1.i].y, pts[best1.j].x, pts[best1.j].y);
+        drawRect(poly.x[best1.i], poly.y[best1.i], poly.x[best1.j], poly.y[best1.j]);
       }
 
       // draw current test (cyan outline)
@@ -409,12 +313,12 @@ int main(int argc, char *argv[])
   }
 
   // compute actual best for part 1
-  for (size_t i = 0; i < n; i++)
+  for (size_t i = 0; i < poly.n; i++)
   {
-    for (size_t j = i + 1; j < n; j++)
+    for (size_t j = i + 1; j < poly.n; j++)
     {
-      long long dx = llabs((long long)pts[i].x - (long long)pts[j].x);
-      long long dy = llabs((long long)pts[i].y - (long long)pts[j].y);
+      long long dx = llabs((long long)poly.x[i] - (long long)poly.x[j]);
+      long long dy = llabs((long long)poly.y[i] - (long long)poly.y[j]);
       long long area = (dx + 1) * (dy + 1);
       if (area > best1.area)
       {
@@ -438,10 +342,10 @@ int main(int argc, char *argv[])
     if (flash % 2 == 0)
     {
       setColor(66, 135, 245, 100);
-      fillRect(pts[best1.i].x, pts[best1.i].y, pts[best1.j].x, pts[best1.j].y);
+      fillRect(poly.x[best1.i], poly.y[best1.i], poly.x[best1.j], poly.y[best1.j]);
     }
     setColor(66, 135, 245, 255);
-    drawRect(pts[best1.i].x, pts[best1.i].y, pts[best1.j].x, pts[best1.j].y);
+    drawRect(poly.x[best1.i], poly.y[best1.i], poly.x[best1.j], poly.y[best1.j]);
 
     drawPolygonFull();
     SDL_RenderPresent(renderer);
@@ -454,15 +358,15 @@ int main(int argc, char *argv[])
   printf("phase 3: searching part 2...\n");
   Rectangle best2 = {0, 0, 0, 0, 0, -1, -1};
 
-  for (size_t i = 0; i < n; i += step)
+  for (size_t i = 0; i < poly.n; i += step)
   {
-    for (size_t j = i + 1; j < n; j += step)
+    for (size_t j = i + 1; j < poly.n; j += step)
     {
       if (!handleEvents())
         goto cleanup;
 
-      int x1 = pts[i].x, y1 = pts[i].y;
-      int x2 = pts[j].x, y2 = pts[j].y;
+      int x1 = poly.x[i], y1 = poly.y[i];
+      int x2 = poly.x[j], y2 = poly.y[j];
       int minx = (x1 < x2) ? x1 : x2;
       int maxx = (x1 < x2) ? x2 : x1;
       int miny = (y1 < y2) ? y1 : y2;
@@ -471,22 +375,22 @@ int main(int argc, char *argv[])
       long long dx = maxx - minx;
       long long dy = maxy - miny;
       long long area = (dx + 1) * (dy + 1);
-      int valid = isValidPart2(minx, miny, maxx, maxy);
+      int valid = validRectangle(minx, miny, maxx, maxy);
 
       setColor(20, 20, 40, 255);
       SDL_RenderClear(renderer);
 
       // draw part 1 best (dim blue)
       setColor(66, 135, 245, 30);
-      fillRect(pts[best1.i].x, pts[best1.i].y, pts[best1.j].x, pts[best1.j].y);
+      fillRect(poly.x[best1.i], poly.y[best1.i], poly.x[best1.j], poly.y[best1.j]);
 
       // draw part 2 best so far (green fill)
       if (best2.i >= 0)
       {
         setColor(76, 217, 100, 80);
-        fillRect(pts[best2.i].x, pts[best2.i].y, pts[best2.j].x, pts[best2.j].y);
+        fillRect(poly.x[best2.i], poly.y[best2.i], poly.x[best2.j], poly.y[best2.j]);
         setColor(76, 217, 100, 220);
-        drawRect(pts[best2.i].x, pts[best2.i].y, pts[best2.j].x, pts[best2.j].y);
+        drawRect(poly.x[best2.i], poly.y[best2.i], poly.x[best2.j], poly.y[best2.j]);
       }
 
       // draw current test
@@ -522,12 +426,12 @@ int main(int argc, char *argv[])
   }
 
   // compute actual best for part 2
-  for (size_t i = 0; i < n; i++)
+  for (size_t i = 0; i < poly.n; i++)
   {
-    for (size_t j = i + 1; j < n; j++)
+    for (size_t j = i + 1; j < poly.n; j++)
     {
-      int x1 = pts[i].x, y1 = pts[i].y;
-      int x2 = pts[j].x, y2 = pts[j].y;
+      int x1 = poly.x[i], y1 = poly.y[i];
+      int x2 = poly.x[j], y2 = poly.y[j];
       int minx = (x1 < x2) ? x1 : x2;
       int maxx = (x1 < x2) ? x2 : x1;
       int miny = (y1 < y2) ? y1 : y2;
@@ -537,7 +441,7 @@ int main(int argc, char *argv[])
       long long dy = maxy - miny;
       long long area = (dx + 1) * (dy + 1);
 
-      if (area > best2.area && isValidPart2(minx, miny, maxx, maxy))
+      if (area > best2.area && validRectangle(minx, miny, maxx, maxy))
       {
         best2.area = area;
         best2.i = (int)i;
@@ -571,25 +475,25 @@ int main(int argc, char *argv[])
     // part 1 rectangle (blue, pulsing)
     int alpha1 = 40 + (int)(20 * sin(t * 0.05));
     setColor(66, 135, 245, alpha1);
-    fillRect(pts[best1.i].x, pts[best1.i].y, pts[best1.j].x, pts[best1.j].y);
+    fillRect(poly.x[best1.i], poly.y[best1.i], poly.x[best1.j], poly.y[best1.j]);
     setColor(66, 135, 245, 180);
-    drawRect(pts[best1.i].x, pts[best1.i].y, pts[best1.j].x, pts[best1.j].y);
+    drawRect(poly.x[best1.i], poly.y[best1.i], poly.x[best1.j], poly.y[best1.j]);
 
     // part 2 rectangle (green, pulsing)
     int alpha2 = 80 + (int)(30 * sin(t * 0.07 + 1));
     setColor(76, 217, 100, alpha2);
-    fillRect(pts[best2.i].x, pts[best2.i].y, pts[best2.j].x, pts[best2.j].y);
+    fillRect(poly.x[best2.i], poly.y[best2.i], poly.x[best2.j], poly.y[best2.j]);
     setColor(76, 217, 100, 255);
-    drawRect(pts[best2.i].x, pts[best2.i].y, pts[best2.j].x, pts[best2.j].y);
+    drawRect(poly.x[best2.i], poly.y[best2.i], poly.x[best2.j], poly.y[best2.j]);
 
     // highlight corners
     setColor(66, 135, 245, 255);
-    fillCircle(pts[best1.i].x, pts[best1.i].y, 6);
-    fillCircle(pts[best1.j].x, pts[best1.j].y, 6);
+    fillCircle(poly.x[best1.i], poly.y[best1.i], 6);
+    fillCircle(poly.x[best1.j], poly.y[best1.j], 6);
 
     setColor(76, 217, 100, 255);
-    fillCircle(pts[best2.i].x, pts[best2.i].y, 8);
-    fillCircle(pts[best2.j].x, pts[best2.j].y, 8);
+    fillCircle(poly.x[best2.i], poly.y[best2.i], 8);
+    fillCircle(poly.x[best2.j], poly.y[best2.j], 8);
 
     drawPolygonFull();
 
@@ -602,7 +506,9 @@ cleanup:
   SDL_DestroyRenderer(renderer);
   SDL_DestroyWindow(window);
   SDL_Quit();
-  free(pts);
+  if (indexed)
+    freePolygonIndex(&poly_index);
+  freePolygon(&poly);
 
   printf("\nfinal results:\n");
   printf("part 1: %lld\n", best1.area);
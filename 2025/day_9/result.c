@@ -1,26 +1,207 @@
+// compile: gcc -std=c11 -O2 -o result result.c
+#define _DEFAULT_SOURCE
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-char *readFile()
+typedef struct
 {
-  FILE *file = fopen("input/input.txt", "r");
-  static char content[10000];
-  char line[1000];
+  int x, y;
+} Point;
 
-  if (file)
+// growable array of points
+typedef struct
+{
+  Point *data;
+  size_t count;
+  size_t cap;
+} PointArray;
+
+int pushPoint(PointArray *points, int x, int y)
+{
+  if (points->count == points->cap)
+  {
+    size_t cap = points->cap ? points->cap * 2 : 512;
+    Point *tmp = realloc(points->data, cap * sizeof(Point));
+    if (!tmp)
+      return 0;
+    points->data = tmp;
+    points->cap = cap;
+  }
+  points->data[points->count].x = x;
+  points->data[points->count].y = y;
+  points->count++;
+  return 1;
+}
+
+// read an optionally signed integer at *p like %d, returns 0 if there is no digit
+static int scanInt(const char **p, const char *end, int *value)
+{
+  const char *s = *p;
+  while (s < end && (*s == ' ' || *s == '\t'))
+    s++;
+  int negative = 0;
+  if (s < end && *s == '-')
   {
-    content[0] = '\0';
-    while (fgets(line, sizeof(line), file))
+    negative = 1;
+    s++;
+  }
+  if (s >= end || (unsigned)(*s - '0') > 9)
+    return 0;
+
+  long long v = 0;
+  while (s < end && (unsigned)(*s - '0') <= 9)
+  {
+    v = v * 10 + (*s - '0');
+    s++;
+  }
+  *value = (int)(negative ? -v : v);
+  *p = s;
+  return 1;
+}
+
+// parse "x,y" lines in one pass, lines that don't start with a point are skipped
+int parsePoints(const char *text, size_t len, PointArray *points)
+{
+  const char *p = text;
+  const char *end = text + len;
+  while (p < end)
+  {
+    int x, y;
+    const char *s = p;
+    if (scanInt(&s, end, &x) && s < end && *s == ',' && (s++, scanInt(&s, end, &y)))
     {
-      strcat(content, line);
+      if (!pushPoint(points, x, y))
+        return 0;
     }
-    fclose(file);
-    return content;
+
+    const char *eol = memchr(s, '\n', end - s);
+    p = eol ? eol + 1 : end;
+  }
+  return 1;
+}
+
+// map the file and parse it straight into points, returns 0 if it can't be read
+int loadPoints(const char *path, PointArray *points)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return 0;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0)
+  {
+    close(fd);
+    return 0;
+  }
+  if (info.st_size == 0)
+  {
+    close(fd);
+    return 1;
+  }
+
+  size_t len = info.st_size;
+  const char *text = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (text == MAP_FAILED)
+    return 0;
+  madvise((void *)text, len, MADV_SEQUENTIAL);
+
+  int ok = parsePoints(text, len, points);
+  munmap((void *)text, len);
+  return ok;
+}
+
+// axis-aligned polygon edges in structure-of-arrays form
+typedef struct
+{
+  size_t count;
+  int *at;      // x of a vertical edge, y of a horizontal one
+  int *lo, *hi; // span along the other axis
+} EdgeList;
+
+// the red tiles in input order, closed back to the first one
+typedef struct
+{
+  size_t n;
+  int *x, *y;
+  int min_x, max_x, min_y, max_y;
+  EdgeList vertical, horizontal; // diagonal edges are in neither
+} Polygon;
+
+static int allocEdges(EdgeList *edges, size_t n)
+{
+  edges->count = 0;
+  edges->at = malloc(n * sizeof(int));
+  edges->lo = malloc(n * sizeof(int));
+  edges->hi = malloc(n * sizeof(int));
+  return edges->at && edges->lo && edges->hi;
+}
+
+static void addEdge(EdgeList *edges, int at, int a, int b)
+{
+  edges->at[edges->count] = at;
+  edges->lo[edges->count] = a < b ? a : b;
+  edges->hi[edges->count] = a < b ? b : a;
+  edges->count++;
+}
+
+void freePolygon(Polygon *poly)
+{
+  free(poly->x);
+  free(poly->y);
+  free(poly->vertical.at);
+  free(poly->vertical.lo);
+  free(poly->vertical.hi);
+  free(poly->horizontal.at);
+  free(poly->horizontal.lo);
+  free(poly->horizontal.hi);
+  memset(poly, 0, sizeof(*poly));
+}
+
+// build the polygon from the parsed points, returns 0 if out of memory
+int buildPolygon(const Point *pts, size_t n, Polygon *poly)
+{
+  memset(poly, 0, sizeof(*poly));
+  if (n == 0)
+    return 1;
+
+  poly->n = n;
+  poly->x = malloc(n * sizeof(int));
+  poly->y = malloc(n * sizeof(int));
+  if (!poly->x || !poly->y || !allocEdges(&poly->vertical, n) || !allocEdges(&poly->horizontal, n))
+  {
+    freePolygon(poly);
+    return 0;
   }
 
-  return "";
+  poly->min_x = poly->max_x = pts[0].x;
+  poly->min_y = poly->max_y = pts[0].y;
+  for (size_t i = 0; i < n; i++)
+  {
+    poly->x[i] = pts[i].x;
+    poly->y[i] = pts[i].y;
+    if (pts[i].x < poly->min_x)
+      poly->min_x = pts[i].x;
+    if (pts[i].x > poly->max_x)
+      poly->max_x = pts[i].x;
+    if (pts[i].y < poly->min_y)
+      poly->min_y = pts[i].y;
+    if (pts[i].y > poly->max_y)
+      poly->max_y = pts[i].y;
+
+    const Point *next = &pts[(i + 1) % n];
+    if (pts[i].x == next->x)
+      addEdge(&poly->vertical, pts[i].x, pts[i].y, next->y);
+    else if (pts[i].y == next->y)
+      addEdge(&poly->horizontal, pts[i].y, pts[i].x, next->x);
+  }
+  return 1;
 }
 
 // find the biggest possible rectangle that can be spanned with the two given corner points
@@ -29,158 +210,721 @@ char *readFile()
 // after that we can translate the corner points from xxxx, xxxx to x,y coordinates for each point
 // and then calculate the area of the rectangle spanned by these two points
 
-long long solvePart1(char *input)
+// part 1 engines
+// PART1_BRUTE_FORCE: every pair, O(n^2)
+// PART1_STAIRCASE: only pairs between opposing staircases, O(n log n)
+typedef enum
+{
+  PART1_BRUTE_FORCE,
+  PART1_STAIRCASE
+} Part1Engine;
+
+static long long part1BruteForce(const Polygon *poly, size_t *best_i, size_t *best_j)
 {
-  if (input == NULL || input[0] == '\0')
+  size_t n = poly->n;
+  const int *xs = poly->x, *ys = poly->y;
+  long long max_area = 0;
+  for (size_t i = 0; i < n; i++)
   {
-    return 0;
+    for (size_t j = i + 1; j < n; j++)
+    {
+      long long dx = llabs((long long)xs[i] - (long long)xs[j]);
+      long long dy = llabs((long long)ys[i] - (long long)ys[j]);
+      long long area = (dx + 1) * (dy + 1);
+      if (area > max_area)
+      {
+        max_area = area;
+        *best_i = i;
+        *best_j = j;
+      }
+    }
   }
+  return max_area;
+}
 
-  // parse all points into an array
-  size_t len = strlen(input);
-  char *buf = malloc(len + 1);
-  if (!buf)
-    return 0;
-  memcpy(buf, input, len + 1);
+// a point on a staircase, x is mirrored for the anti-diagonal pass
+typedef struct
+{
+  long long x, y;
+  size_t index;
+} StairPoint;
+
+static int compareStairPoints(const void *a, const void *b)
+{
+  const StairPoint *p = a, *q = b;
+  if (p->x != q->x)
+    return p->x < q->x ? -1 : 1;
+  return (p->y > q->y) - (p->y < q->y);
+}
 
-  size_t cap = 512;
-  size_t n = 0;
-  typedef struct
+// Sort by x, then y: LSD radix sort on the offsets from the bounding box packed into
+// one 64-bit key, a byte per pass, skipping bytes that are the same for every point.
+// Only keys and positions move during the passes, the points are gathered once.
+static void sortStairPoints(StairPoint *pts, size_t n, long long min_x, long long min_y)
+{
+  unsigned long long *keys = malloc(2 * n * sizeof(unsigned long long));
+  size_t *order = malloc(2 * n * sizeof(size_t));
+  StairPoint *sorted = malloc(n * sizeof(StairPoint));
+  if (!keys || !order || !sorted)
   {
-    int x, y;
-  } Point;
-  Point *pts = malloc(cap * sizeof(Point));
-  if (!pts)
+    free(keys);
+    free(order);
+    free(sorted);
+    qsort(pts, n, sizeof(StairPoint), compareStairPoints);
+    return;
+  }
+
+  unsigned long long *src_keys = keys, *dst_keys = keys + n;
+  size_t *src = order, *dst = order + n;
+  for (size_t i = 0; i < n; i++)
   {
-    free(buf);
-    return 0;
+    src_keys[i] = (unsigned long long)(pts[i].x - min_x) << 32 | (unsigned long long)(pts[i].y - min_y);
+    src[i] = i;
   }
 
-  char *line = strtok(buf, "\n");
-  while (line)
+  for (int shift = 0; shift < 64; shift += 8)
   {
-    int x, y;
-    if (sscanf(line, "%d,%d", &x, &y) == 2)
+    size_t count[256] = {0};
+    for (size_t i = 0; i < n; i++)
+      count[(src_keys[i] >> shift) & 0xFF]++;
+    if (count[(src_keys[0] >> shift) & 0xFF] == n)
+      continue;
+
+    size_t offset = 0;
+    for (int d = 0; d < 256; d++)
     {
-      if (n >= cap)
-      {
-        cap *= 2;
-        Point *tmp = realloc(pts, cap * sizeof(Point));
-        if (!tmp)
-          break;
-        pts = tmp;
-      }
-      pts[n].x = x;
-      pts[n].y = y;
-      n++;
+      size_t c = count[d];
+      count[d] = offset;
+      offset += c;
     }
-    line = strtok(NULL, "\n");
+    for (size_t i = 0; i < n; i++)
+    {
+      size_t at = count[(src_keys[i] >> shift) & 0xFF]++;
+      dst_keys[at] = src_keys[i];
+      dst[at] = src[i];
+    }
+
+    unsigned long long *swap_keys = src_keys;
+    src_keys = dst_keys;
+    dst_keys = swap_keys;
+    size_t *swap = src;
+    src = dst;
+    dst = swap;
   }
 
-  free(buf);
+  for (size_t i = 0; i < n; i++)
+    sorted[i] = pts[src[i]];
+  memcpy(pts, sorted, n * sizeof(StairPoint));
+  free(keys);
+  free(order);
+  free(sorted);
+}
 
-  if (n < 2)
+typedef struct
+{
+  const StairPoint *low, *high; // lower-left and upper-right staircase, both by x
+  long long best;
+  size_t best_low, best_high;
+} StairSearch;
+
+// area of the rectangle from low to high; when high is not above and right of low
+// this is at most the area of some other real pair, so it never wins wrongly
+static long long stairArea(const StairPoint *low, const StairPoint *high)
+{
+  return (high->x - low->x + 1) * (high->y - low->y + 1);
+}
+
+// the best high for every low in [lo, hi], knowing it is in [from, to].
+// stairArea is Monge over two staircases sorted by x, so the best high of a later
+// low is never left of an earlier low's one and each level scans every high once
+static void searchStairs(StairSearch *search, size_t lo, size_t hi, size_t from, size_t to)
+{
+  size_t mid = lo + (hi - lo) / 2;
+  size_t arg = from;
+  long long best = stairArea(&search->low[mid], &search->high[from]);
+  for (size_t j = from + 1; j <= to; j++)
+  {
+    long long area = stairArea(&search->low[mid], &search->high[j]);
+    if (area > best)
+    {
+      best = area;
+      arg = j;
+    }
+  }
+  if (best > search->best)
+  {
+    search->best = best;
+    search->best_low = search->low[mid].index;
+    search->best_high = search->high[arg].index;
+  }
+
+  if (mid > lo)
+    searchStairs(search, lo, mid - 1, from, arg);
+  if (mid < hi)
+    searchStairs(search, mid + 1, hi, arg, to);
+}
+
+// Walk pts (sorted by x, then y) forwards or backwards and keep every point that is
+// below (or above) all the points kept before it, with x negated when mirrored.
+// Points sharing an x can both be kept; they are dominated by the staircase point
+// and only ever score less, which keeps the search exact.
+static size_t buildStair(const StairPoint *pts, size_t n, int forward, int below, int mirror, StairPoint *out)
+{
+  size_t count = 0;
+  for (size_t k = 0; k < n; k++)
+  {
+    const StairPoint *p = &pts[forward ? k : n - 1 - k];
+    if (count == 0 || (below ? p->y < out[count - 1].y : p->y > out[count - 1].y))
+    {
+      out[count] = *p;
+      if (mirror)
+        out[count].x = -out[count].x;
+      count++;
+    }
+  }
+  return count;
+}
+
+// The best rectangle has one corner below and left of the other, or one corner
+// above and left of it. For the first case only the lower-left staircase (points
+// nothing else is below and left of) and the upper-right one can be optimal
+// corners. The second case is the first with x mirrored; one sort serves both.
+static long long part1Staircase(const Polygon *poly, size_t *best_i, size_t *best_j)
+{
+  size_t n = poly->n;
+  StairPoint *pts = malloc(n * sizeof(StairPoint));
+  StairPoint *low = malloc(n * sizeof(StairPoint));
+  StairPoint *high = malloc(n * sizeof(StairPoint));
+  if (!pts || !low || !high)
   {
     free(pts);
-    return 0;
+    free(low);
+    free(high);
+    return part1BruteForce(poly, best_i, best_j);
   }
 
-  long long max_area = 0;
-  int best_i = -1, best_j = -1;
+  // The extreme points along both diagonals: anything that one of them beats in
+  // every staircase direction can't be on any staircase, which usually leaves few
+  // enough points that sorting them is cheap
+  const int *xs = poly->x, *ys = poly->y;
+  size_t ll = 0, ur = 0, ul = 0, lr = 0;
+  for (size_t i = 1; i < n; i++)
+  {
+    long long sum = (long long)xs[i] + ys[i], diff = (long long)ys[i] - xs[i];
+    if (sum < (long long)xs[ll] + ys[ll])
+      ll = i;
+    if (sum > (long long)xs[ur] + ys[ur])
+      ur = i;
+    if (diff > (long long)ys[ul] - xs[ul])
+      ul = i;
+    if (diff < (long long)ys[lr] - xs[lr])
+      lr = i;
+  }
+
+  size_t m = 0;
   for (size_t i = 0; i < n; i++)
   {
-    for (size_t j = i + 1; j < n; j++)
+    int x = xs[i], y = ys[i];
+    int beaten = xs[ll] <= x && ys[ll] <= y && (xs[ll] < x || ys[ll] < y) &&
+                 xs[ur] >= x && ys[ur] >= y && (xs[ur] > x || ys[ur] > y) &&
+                 xs[ul] <= x && ys[ul] >= y && (xs[ul] < x || ys[ul] > y) &&
+                 xs[lr] >= x && ys[lr] <= y && (xs[lr] > x || ys[lr] < y);
+    if (!beaten)
     {
-      long long dx = llabs((long long)pts[i].x - (long long)pts[j].x);
-      long long dy = llabs((long long)pts[i].y - (long long)pts[j].y);
-      long long area = (dx + 1) * (dy + 1);
-      if (area > max_area)
-      {
-        max_area = area;
-        best_i = (int)i;
-        best_j = (int)j;
-      }
+      pts[m].x = x;
+      pts[m].y = y;
+      pts[m].index = i;
+      m++;
     }
   }
+  n = m;
+  sortStairPoints(pts, n, poly->min_x, poly->min_y);
 
-  // optionally, we could print the best pair
-  if (best_i != -1 && best_j != -1)
+  long long max_area = 0;
+  for (int mirror = 0; mirror < 2; mirror++)
   {
-    printf("Best corners: (%d,%d) and (%d,%d) => area=%lld\n", pts[best_i].x, pts[best_i].y, pts[best_j].x, pts[best_j].y, max_area);
+    // both staircases by ascending (mirrored) x, the upper one is built the other way round
+    size_t low_count = buildStair(pts, n, !mirror, 1, mirror, low);
+    size_t high_count = buildStair(pts, n, mirror, 0, mirror, high);
+    for (size_t i = 0; i < high_count / 2; i++)
+    {
+      StairPoint tmp = high[i];
+      high[i] = high[high_count - 1 - i];
+      high[high_count - 1 - i] = tmp;
+    }
+
+    StairSearch search = {low, high, 0, 0, 0};
+    searchStairs(&search, 0, low_count - 1, 0, high_count - 1);
+    if (search.best > max_area)
+    {
+      max_area = search.best;
+      *best_i = search.best_low < search.best_high ? search.best_low : search.best_high;
+      *best_j = search.best_low < search.best_high ? search.best_high : search.best_low;
+    }
   }
 
   free(pts);
+  free(low);
+  free(high);
   return max_area;
 }
 
-long long solvePart2(char *input)
+long long solvePart1(const Polygon *poly, Part1Engine engine)
 {
-  if (input == NULL || input[0] == '\0')
+  const int *xs = poly->x, *ys = poly->y;
+  if (poly->n < 2)
     return 0;
 
-  size_t len = strlen(input);
-  char *buf = malloc(len + 1);
-  if (!buf)
+  size_t best_i = 0, best_j = 0;
+  long long max_area = engine == PART1_STAIRCASE ? part1Staircase(poly, &best_i, &best_j) : part1BruteForce(poly, &best_i, &best_j);
+
+  // optionally, we could print the best pair
+  if (max_area > 0)
+  {
+    printf("Best corners: (%d,%d) and (%d,%d) => area=%lld\n", xs[best_i], ys[best_i], xs[best_j], ys[best_j], max_area);
+  }
+
+  return max_area;
+}
+
+// does any edge lie strictly between at_min and at_max and overlap (span_min, span_max)?
+// branch-free over blocks of edges so the compiler can vectorize, exits between blocks
+static int edgesCross(const EdgeList *edges, int at_min, int at_max, int span_min, int span_max)
+{
+  for (size_t start = 0; start < edges->count; start += 64)
+  {
+    size_t end = start + 64 < edges->count ? start + 64 : edges->count;
+    int hit = 0;
+    for (size_t k = start; k < end; k++)
+      hit |= (edges->at[k] > at_min) & (edges->at[k] < at_max) & (edges->lo[k] < span_max) & (edges->hi[k] > span_min);
+    if (hit)
+      return 1;
+  }
+  return 0;
+}
+
+// a rectangle only has red/green tiles if no polygon edge passes through its interior
+// (touching the boundary is fine) and its center is inside the polygon
+int isValidRectangle(const Polygon *poly, int minx, int miny, int maxx, int maxy)
+{
+  if (edgesCross(&poly->vertical, minx, maxx, miny, maxy) || edgesCross(&poly->horizontal, miny, maxy, minx, maxx))
     return 0;
-  memcpy(buf, input, len + 1);
 
-  size_t cap = 512;
-  size_t n = 0;
-  typedef struct
+  // ray cast from the center of the rectangle
+  int cx = (minx + maxx) / 2;
+  int cy = (miny + maxy) / 2;
+  int crossings = 0;
+  for (size_t k = 0; k < poly->n; k++)
   {
-    int x, y;
-  } Point;
-  Point *pts = malloc(cap * sizeof(Point));
-  if (!pts)
+    size_t next = (k + 1) % poly->n;
+    int px1 = poly->x[k], py1 = poly->y[k];
+    int px2 = poly->x[next], py2 = poly->y[next];
+    if ((py1 <= cy && cy < py2) || (py2 <= cy && cy < py1))
+    {
+      double t = (double)(cy - py1) / (py2 - py1);
+      double x_intersect = px1 + t * (px2 - px1);
+      if (cx < x_intersect)
+        crossings++;
+    }
+  }
+  return (crossings % 2) == 1;
+}
+
+// Merge-sort tree over one list of edges.
+// Level 0 is the edges sorted by their fixed coordinate. Level k cuts that order
+// into blocks of 2^k edges and sorts each block by lo, next to the running maximum
+// of hi inside the block. Any run of edges in at order splits into O(log n) whole
+// blocks, and a binary search in each answers both queries, so they take O(log^2 n).
+// O(n log n) ints per level array.
+typedef struct
+{
+  size_t count;
+  int levels;
+  int *at;     // sorted
+  int *lo;     // levels * count, level k at lo + k * count
+  int *hi_max; // running max of hi over each block in lo order
+  int *hi;     // each block's hi values sorted, only if built for counting
+} EdgeIndex;
+
+void freeEdgeIndex(EdgeIndex *index)
+{
+  free(index->at);
+  free(index->lo);
+  free(index->hi_max);
+  free(index->hi);
+  memset(index, 0, sizeof(*index));
+}
+
+// an edge's position in its EdgeList, sorted by at
+typedef struct
+{
+  int at;
+  size_t index;
+} EdgeOrder;
+
+static int compareEdgeOrder(const void *a, const void *b)
+{
+  const EdgeOrder *p = a, *q = b;
+  return (p->at > q->at) - (p->at < q->at);
+}
+
+// merge the two sorted halves of every block of src into dst, moving the
+// matching values of src_b/dst_b along when given
+static void mergeLevel(const int *src, const int *src_b, int *dst, int *dst_b, size_t count, size_t block)
+{
+  for (size_t start = 0; start < count; start += block)
   {
-    free(buf);
+    size_t mid = start + block / 2 < count ? start + block / 2 : count;
+    size_t end = start + block < count ? start + block : count;
+    size_t i = start, j = mid, k = start;
+    while (i < mid || j < end)
+    {
+      size_t from = (j >= end || (i < mid && src[i] <= src[j])) ? i++ : j++;
+      dst[k] = src[from];
+      if (src_b)
+        dst_b[k] = src_b[from];
+      k++;
+    }
+  }
+}
+
+// returns 0 if out of memory
+int buildEdgeIndex(const EdgeList *edges, int with_counts, EdgeIndex *index)
+{
+  memset(index, 0, sizeof(*index));
+  size_t n = edges->count;
+  index->count = n;
+  index->levels = 1;
+  while (((size_t)1 << (index->levels - 1)) < n)
+    index->levels++;
+
+  size_t cells = (size_t)index->levels * (n ? n : 1);
+  EdgeOrder *order = malloc((n ? n : 1) * sizeof(EdgeOrder));
+  index->at = malloc((n ? n : 1) * sizeof(int));
+  index->lo = malloc(cells * sizeof(int));
+  index->hi_max = malloc(cells * sizeof(int));
+  index->hi = with_counts ? malloc(cells * sizeof(int)) : NULL;
+  if (!order || !index->at || !index->lo || !index->hi_max || (with_counts && !index->hi))
+  {
+    free(order);
+    freeEdgeIndex(index);
     return 0;
   }
 
-  char *line = strtok(buf, "\n");
-  while (line)
+  for (size_t i = 0; i < n; i++)
   {
-    int x, y;
-    if (sscanf(line, "%d,%d", &x, &y) == 2)
+    order[i].at = edges->at[i];
+    order[i].index = i;
+  }
+  qsort(order, n, sizeof(EdgeOrder), compareEdgeOrder);
+  for (size_t i = 0; i < n; i++)
+  {
+    size_t e = order[i].index;
+    index->at[i] = edges->at[e];
+    index->lo[i] = edges->lo[e];
+    index->hi_max[i] = edges->hi[e];
+    if (with_counts)
+      index->hi[i] = edges->hi[e];
+  }
+  free(order);
+
+  // hi_max holds the raw hi values while the levels are merged
+  for (int k = 1; k < index->levels; k++)
+  {
+    size_t block = (size_t)1 << k;
+    mergeLevel(index->lo + (k - 1) * n, index->hi_max + (k - 1) * n, index->lo + k * n, index->hi_max + k * n, n, block);
+    if (with_counts)
+      mergeLevel(index->hi + (k - 1) * n, NULL, index->hi + k * n, NULL, n, block);
+  }
+  for (int k = 1; k < index->levels; k++)
+  {
+    size_t block = (size_t)1 << k;
+    int *hi_max = index->hi_max + k * n;
+    for (size_t i = 0; i < n; i++)
     {
-      if (n >= cap)
-      {
-        cap *= 2;
-        Point *tmp = realloc(pts, cap * sizeof(Point));
-        if (!tmp)
-          break;
-        pts = tmp;
-      }
-      pts[n].x = x;
-      pts[n].y = y;
-      n++;
+      if (i % block != 0 && hi_max[i - 1] > hi_max[i])
+        hi_max[i] = hi_max[i - 1];
     }
-    line = strtok(NULL, "\n");
   }
+  return 1;
+}
+
+// first position in values[from, to) whose value is >= key (or > key if after)
+static size_t searchValues(const int *values, size_t from, size_t to, int key, int after)
+{
+  while (from < to)
+  {
+    size_t mid = from + (to - from) / 2;
+    if (values[mid] < key || (after && values[mid] == key))
+      from = mid + 1;
+    else
+      to = mid;
+  }
+  return from;
+}
 
-  free(buf);
+// the largest aligned block starting at l that fits in [l, r), as its level
+static int blockLevel(const EdgeIndex *index, size_t l, size_t r)
+{
+  int k = 0;
+  while (k + 1 < index->levels && l % ((size_t)2 << k) == 0 && l + ((size_t)2 << k) <= r)
+    k++;
+  return k;
+}
 
-  if (n < 2)
+// same question as edgesCross
+static int indexCrosses(const EdgeIndex *index, int at_min, int at_max, int span_min, int span_max)
+{
+  size_t n = index->count;
+  size_t l = searchValues(index->at, 0, n, at_min, 1);
+  size_t r = searchValues(index->at, 0, n, at_max, 0);
+  while (l < r)
   {
-    free(pts);
+    int k = blockLevel(index, l, r);
+    size_t end = l + ((size_t)1 << k);
+    const int *lo = index->lo + k * n;
+    size_t below = searchValues(lo, l, end, span_max, 0); // edges starting before span_max
+    if (below > l && index->hi_max[k * n + below - 1] > span_min)
+      return 1;
+    l = end;
+  }
+  return 0;
+}
+
+// number of edges with at > at_min and lo <= key < hi
+static size_t indexCountSpanning(const EdgeIndex *index, int at_min, int key)
+{
+  size_t n = index->count;
+  size_t l = searchValues(index->at, 0, n, at_min, 1);
+  size_t total = 0;
+  while (l < n)
+  {
+    int k = blockLevel(index, l, n);
+    size_t end = l + ((size_t)1 << k);
+    total += searchValues(index->lo + k * n, l, end, key, 1) - searchValues(index->hi + k * n, l, end, key, 1);
+    l = end;
+  }
+  return total;
+}
+
+// both edge lists indexed, for polygons whose edges are all axis-aligned
+typedef struct
+{
+  EdgeIndex vertical, horizontal;
+} PolygonIndex;
+
+void freePolygonIndex(PolygonIndex *index)
+{
+  freeEdgeIndex(&index->vertical);
+  freeEdgeIndex(&index->horizontal);
+}
+
+// returns 0 if out of memory or the polygon has a diagonal edge
+int buildPolygonIndex(const Polygon *poly, PolygonIndex *index)
+{
+  memset(index, 0, sizeof(*index));
+  if (poly->vertical.count + poly->horizontal.count != poly->n)
+    return 0;
+  if (!buildEdgeIndex(&poly->vertical, 1, &index->vertical) || !buildEdgeIndex(&poly->horizontal, 0, &index->horizontal))
+  {
+    freePolygonIndex(index);
     return 0;
   }
+  return 1;
+}
 
-  // find polygon bounding box
-  int min_x = pts[0].x, max_x = pts[0].x;
-  int min_y = pts[0].y, max_y = pts[0].y;
-  for (size_t i = 1; i < n; i++)
+// isValidRectangle in O(log^2 n): the ray from the center only meets vertical edges
+int isValidRectangleIndexed(const PolygonIndex *index, int minx, int miny, int maxx, int maxy)
+{
+  if (indexCrosses(&index->vertical, minx, maxx, miny, maxy) || indexCrosses(&index->horizontal, miny, maxy, minx, maxx))
+    return 0;
+
+  int cx = (minx + maxx) / 2;
+  int cy = (miny + maxy) / 2;
+  return indexCountSpanning(&index->vertical, cx, cy) % 2 == 1;
+}
+
+// Inside/outside raster of the polygon on its compressed coordinates.
+// Column 2a is the line x = xs[a] and column 2a + 1 the open strip between xs[a]
+// and xs[a + 1], rows likewise, so each cell is wholly inside or wholly outside
+// the closed polygon. outside holds 2D prefix sums of the outside cells, so the
+// rectangle between two vertices is valid iff its sum is zero.
+typedef struct
+{
+  size_t width, height;
+  size_t *col, *row; // each vertex's cell
+  unsigned *outside; // (width + 1) * (height + 1)
+} PrefixGrid;
+
+// beyond this the grid falls back to the edge index (about 80 MB while building)
+#define PREFIX_GRID_MAX_CELLS ((size_t)1 << 24)
+
+void freePrefixGrid(PrefixGrid *grid)
+{
+  free(grid->col);
+  free(grid->row);
+  free(grid->outside);
+  memset(grid, 0, sizeof(*grid));
+}
+
+static int compareInts(const void *a, const void *b)
+{
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+// sort and dedupe values in place, returns the distinct count
+static size_t compressCoords(int *values, size_t n)
+{
+  qsort(values, n, sizeof(int), compareInts);
+  size_t count = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    if (count == 0 || values[count - 1] != values[i])
+      values[count++] = values[i];
+  }
+  return count;
+}
+
+// returns 0 if out of memory, the grid would be too big, or the polygon has a diagonal edge
+int buildPrefixGrid(const Polygon *poly, PrefixGrid *grid)
+{
+  memset(grid, 0, sizeof(*grid));
+  size_t n = poly->n;
+  if (n == 0 || poly->vertical.count + poly->horizontal.count != n)
+    return 0;
+
+  int *xs = malloc(n * sizeof(int));
+  int *ys = malloc(n * sizeof(int));
+  if (!xs || !ys)
+  {
+    free(xs);
+    free(ys);
+    return 0;
+  }
+  memcpy(xs, poly->x, n * sizeof(int));
+  memcpy(ys, poly->y, n * sizeof(int));
+  size_t kx = compressCoords(xs, n);
+  size_t ky = compressCoords(ys, n);
+
+  // a flat polygon has no strips to rasterize
+  size_t w = 2 * kx - 1, h = 2 * ky - 1;
+  unsigned char *inside = NULL;
+  if (w > 1 && h > 1 && w <= PREFIX_GRID_MAX_CELLS / h)
+  {
+    inside = calloc(w * h, 1);
+    grid->col = malloc(n * sizeof(size_t));
+    grid->row = malloc(n * sizeof(size_t));
+    grid->outside = malloc((w + 1) * (h + 1) * sizeof(unsigned));
+  }
+  if (!inside || !grid->col || !grid->row || !grid->outside)
+  {
+    free(xs);
+    free(ys);
+    free(inside);
+    freePrefixGrid(grid);
+    return 0;
+  }
+  grid->width = w;
+  grid->height = h;
+
+  for (size_t i = 0; i < n; i++)
   {
-    if (pts[i].x < min_x)
-      min_x = pts[i].x;
-    if (pts[i].x > max_x)
-      max_x = pts[i].x;
-    if (pts[i].y < min_y)
-      min_y = pts[i].y;
-    if (pts[i].y > max_y)
-      max_y = pts[i].y;
+    grid->col[i] = 2 * searchValues(xs, 0, kx, poly->x[i], 0);
+    grid->row[i] = 2 * searchValues(ys, 0, ky, poly->y[i], 0);
   }
 
+  // each vertical edge flips inside/outside for the strips right of it
+  const EdgeList *vertical = &poly->vertical;
+  for (size_t e = 0; e < vertical->count; e++)
+  {
+    size_t c = 2 * searchValues(xs, 0, kx, vertical->at[e], 0) + 1;
+    size_t r0 = 2 * searchValues(ys, 0, ky, vertical->lo[e], 0) + 1;
+    size_t r1 = 2 * searchValues(ys, 0, ky, vertical->hi[e], 0);
+    if (c >= w)
+      continue;
+    for (size_t r = r0; r < r1; r += 2)
+      inside[r * w + c] ^= 1;
+  }
+  for (size_t r = 1; r < h; r += 2)
+  {
+    unsigned char state = 0;
+    for (size_t c = 1; c < w; c += 2)
+    {
+      state ^= inside[r * w + c];
+      inside[r * w + c] = state;
+    }
+  }
+
+  // lines and crossings belong to the closed polygon if any strip touching them does
+  for (size_t r = 0; r < h; r++)
+  {
+    size_t r0 = r % 2 ? r : (r > 0 ? r - 1 : r + 1);
+    size_t r1 = r % 2 ? r : (r + 1 < h ? r + 1 : r - 1);
+    for (size_t c = 0; c < w; c++)
+    {
+      if (r % 2 && c % 2)
+        continue;
+      size_t c0 = c % 2 ? c : (c > 0 ? c - 1 : c + 1);
+      size_t c1 = c % 2 ? c : (c + 1 < w ? c + 1 : c - 1);
+      inside[r * w + c] = inside[r0 * w + c0] | inside[r0 * w + c1] | inside[r1 * w + c0] | inside[r1 * w + c1];
+    }
+  }
+
+  unsigned *sum = grid->outside;
+  for (size_t c = 0; c <= w; c++)
+    sum[c] = 0;
+  for (size_t r = 0; r < h; r++)
+  {
+    unsigned *above = sum + r * (w + 1), *here = above + w + 1;
+    here[0] = 0;
+    for (size_t c = 0; c < w; c++)
+      here[c + 1] = here[c] + above[c + 1] - above[c] + !inside[r * w + c];
+  }
+
+  free(xs);
+  free(ys);
+  free(inside);
+  return 1;
+}
+
+// whether the rectangle with vertices i and j as corners is inside the polygon, in O(1)
+int isValidRectangleGrid(const PrefixGrid *grid, size_t i, size_t j)
+{
+  size_t c0 = grid->col[i] < grid->col[j] ? grid->col[i] : grid->col[j];
+  size_t c1 = (grid->col[i] < grid->col[j] ? grid->col[j] : grid->col[i]) + 1;
+  size_t r0 = grid->row[i] < grid->row[j] ? grid->row[i] : grid->row[j];
+  size_t r1 = (grid->row[i] < grid->row[j] ? grid->row[j] : grid->row[i]) + 1;
+  size_t stride = grid->width + 1;
+  const unsigned *sum = grid->outside;
+  return sum[r1 * stride + c1] - sum[r0 * stride + c1] - sum[r1 * stride + c0] + sum[r0 * stride + c0] == 0;
+}
+
+// part 2 engines
+// PART2_BRUTE_FORCE: every candidate rectangle scans all edges
+// PART2_EDGE_INDEX: candidates are checked against a PolygonIndex, falls back to
+//                   brute force for polygons with diagonal edges
+// PART2_PREFIX_GRID: candidates are checked against a PrefixGrid, falls back to
+//                    the edge index when the grid would be too big
+typedef enum
+{
+  PART2_BRUTE_FORCE,
+  PART2_EDGE_INDEX,
+  PART2_PREFIX_GRID
+} Part2Engine;
+
+long long solvePart2(const Polygon *poly, Part2Engine engine)
+{
+  size_t n = poly->n;
+  const int *xs = poly->x, *ys = poly->y;
+  if (n < 2)
+    return 0;
+
+  PrefixGrid grid;
+  PolygonIndex index;
+  int gridded = engine == PART2_PREFIX_GRID && buildPrefixGrid(poly, &grid);
+  int indexed = !gridded && engine != PART2_BRUTE_FORCE && buildPolygonIndex(poly, &index);
+
   // check each pair of red tiles as rectangle corners
   long long max_area = 0;
   int best_i = -1, best_j = -1;
@@ -189,8 +933,8 @@ long long solvePart2(char *input)
   {
     for (size_t j = i + 1; j < n; j++)
     {
-      int x1 = pts[i].x, y1 = pts[i].y;
-      int x2 = pts[j].x, y2 = pts[j].y;
+      int x1 = xs[i], y1 = ys[i];
+      int x2 = xs[j], y2 = ys[j];
       int minx = (x1 < x2) ? x1 : x2;
       int maxx = (x1 < x2) ? x2 : x1;
       int miny = (y1 < y2) ? y1 : y2;
@@ -204,77 +948,14 @@ long long solvePart2(char *input)
       if (area <= max_area)
         continue;
 
-      // check if any polygon edge passes through the interior of the rectangle
-      // if an edge crosses through the rectangle (not just touches the boundary),
-      // then some tiles inside the rectangle are outside the polygon
-      int valid = 1;
-
-      for (size_t k = 0; k < n && valid; k++)
-      {
-        size_t next = (k + 1) % n;
-        int ex1 = pts[k].x, ey1 = pts[k].y;
-        int ex2 = pts[next].x, ey2 = pts[next].y;
-
-        if (ex1 == ex2)
-        {
-          // vertical edge at x = ex1
-          // check if it crosses through the interior of the rectangle
-          int edge_miny = (ey1 < ey2) ? ey1 : ey2;
-          int edge_maxy = (ey1 < ey2) ? ey2 : ey1;
-
-          // edge is strictly inside rectangle's x range (not on boundary)
-          if (ex1 > minx && ex1 < maxx)
-          {
-            // check if edge's y range overlaps with rectangle's interior
-            if (edge_miny < maxy && edge_maxy > miny)
-            {
-              valid = 0; // edge cuts through rectangle interior
-            }
-          }
-        }
-        else if (ey1 == ey2)
-        {
-          // horizontal edge at y = ey1
-          int edge_minx = (ex1 < ex2) ? ex1 : ex2;
-          int edge_maxx = (ex1 < ex2) ? ex2 : ex1;
-
-          // edge is strictly inside rectangle's y range (not on boundary)
-          if (ey1 > miny && ey1 < maxy)
-          {
-            // check if edge's x range overlaps with rectangle's interior
-            if (edge_minx < maxx && edge_maxx > minx)
-            {
-              valid = 0; // edge cuts through rectangle interior
-            }
-          }
-        }
-      }
-
-      // also check that the rectangle is actually inside the polygon
-      // check the center point of the rectangle
+      int valid;
+      if (gridded)
+        valid = isValidRectangleGrid(&grid, i, j);
+      else if (indexed)
+        valid = isValidRectangleIndexed(&index, minx, miny, maxx, maxy);
+      else
+        valid = isValidRectangle(poly, minx, miny, maxx, maxy);
       if (valid)
-      {
-        int cx = (minx + maxx) / 2;
-        int cy = (miny + maxy) / 2;
-        int crossings = 0;
-        for (size_t k = 0; k < n; k++)
-        {
-          size_t next = (k + 1) % n;
-          int px1 = pts[k].x, py1 = pts[k].y;
-          int px2 = pts[next].x, py2 = pts[next].y;
-          if ((py1 <= cy && cy < py2) || (py2 <= cy && cy < py1))
-          {
-            double t = (double)(cy - py1) / (py2 - py1);
-            double x_intersect = px1 + t * (px2 - px1);
-            if (cx < x_intersect)
-              crossings++;
-          }
-        }
-        if ((crossings % 2) == 0)
-          valid = 0; // center not inside polygon
-      }
-
-      if (valid && area > max_area)
       {
         max_area = area;
         best_i = (int)i;
@@ -283,24 +964,68 @@ long long solvePart2(char *input)
     }
   }
 
+  if (gridded)
+    freePrefixGrid(&grid);
+  if (indexed)
+    freePolygonIndex(&index);
+
   if (best_i != -1 && best_j != -1)
   {
-    printf("Part 2 - Best corners: (%d,%d) and (%d,%d) => area=%lld\n", pts[best_i].x, pts[best_i].y, pts[best_j].x, pts[best_j].y, max_area);
+    printf("Part 2 - Best corners: (%d,%d) and (%d,%d) => area=%lld\n", xs[best_i], ys[best_i], xs[best_j], ys[best_j], max_area);
   }
 
-  free(pts);
   return max_area;
 }
 
-int main()
+#ifndef ANIMATION_MODE
+int main(int argc, char *argv[])
 {
-  char *input = readFile();
+  // --part1=brute checks every pair instead of only the staircases
+  // --part2=brute|index checks rectangles against the edges instead of the prefix grid
+  Part1Engine engine1 = PART1_STAIRCASE;
+  Part2Engine engine2 = PART2_PREFIX_GRID;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--part1=brute") == 0)
+      engine1 = PART1_BRUTE_FORCE;
+    else if (strcmp(argv[i], "--part1=staircase") == 0)
+      engine1 = PART1_STAIRCASE;
+    else if (strcmp(argv[i], "--part2=brute") == 0)
+      engine2 = PART2_BRUTE_FORCE;
+    else if (strcmp(argv[i], "--part2=index") == 0)
+      engine2 = PART2_EDGE_INDEX;
+    else if (strcmp(argv[i], "--part2=grid") == 0)
+      engine2 = PART2_PREFIX_GRID;
+    else
+    {
+      fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  PointArray points = {0};
+  if (!loadPoints("input/input.txt", &points))
+  {
+    fprintf(stderr, "Failed to read input/input.txt\n");
+    return 1;
+  }
 
-  long long area1 = solvePart1(input);
+  Polygon poly;
+  int built = buildPolygon(points.data, points.count, &poly);
+  free(points.data);
+  if (!built)
+  {
+    fprintf(stderr, "Out of memory\n");
+    return 1;
+  }
+
+  long long area1 = solvePart1(&poly, engine1);
   printf("Part 1: Maximum rectangle area: %lld\n", area1);
 
-  long long area2 = solvePart2(input);
+  long long area2 = solvePart2(&poly, engine2);
   printf("Part 2: Maximum rectangle area (red/green only): %lld\n", area2);
 
+  freePolygon(&poly);
   return 0;
-}
\ No newline at end of file
+}
+#endif